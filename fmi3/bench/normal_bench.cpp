@@ -0,0 +1,138 @@
+/**************************************************************************
+ * Copyright (c) ERIGrid 2.0 (H2020 Programme Grant Agreement No. 870620) *
+ * All rights reserved.                                                   *
+ * See file LICENSE in the project root for license information.          *
+ **************************************************************************/
+
+// Micro-benchmark for the random delay generators of the pipeline FMUs.
+//
+// Compares the standard library path (std::normal_distribution over
+// std::default_random_engine, used up to format version 1 of the FMU states) with
+// NormalGenerator (see NormalGenerator.h). For each generator, the time per sample and
+// the first four moments of the samples are measured. For NormalGenerator, a checksum of
+// the first million samples with seed 1 is given as well, which is the same on all
+// platforms (compare the output of different compilers and standard libraries).
+// The results are written to stdout in JSON format.
+//
+// Usage: normal_bench [samples]
+// (configure with -DCMAKE_BUILD_TYPE=Release for meaningful numbers)
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "NormalGenerator.h"
+
+namespace
+{
+    struct Result {
+        std::string generator;
+        size_t samples;
+        double nsPerSample;
+        double mean;
+        double variance;
+        double skewness;
+        double kurtosis;
+    };
+
+    // Draw samples with a generator (functor returning standard normal samples).
+    template<typename Generator>
+    Result run( const char* name, Generator& generator, size_t samples )
+    {
+        double s1 = 0.;
+        double s2 = 0.;
+        double s3 = 0.;
+        double s4 = 0.;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for ( size_t i = 0; i < samples; ++i )
+        {
+            const double z = generator();
+            const double z2 = z * z;
+            s1 += z;
+            s2 += z2;
+            s3 += z2 * z;
+            s4 += z2 * z2;
+        }
+        double ns = std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - start ).count();
+
+        const double n = static_cast<double>( samples );
+        const double mean = s1 / n;
+        const double variance = s2 / n - mean * mean;
+
+        Result result = {
+            name, samples, ns / n, mean, variance,
+            ( s3 / n - 3. * mean * s2 / n + 2. * mean * mean * mean ) / ( variance * std::sqrt( variance ) ),
+            s4 / ( n * variance * variance )
+        };
+
+        return result;
+    }
+
+    // FNV-1a hash over the bit patterns of the first million samples.
+    uint64_t checksum()
+    {
+        NormalGenerator generator( 1 );
+        uint64_t hash = 0xcbf29ce484222325ULL;
+
+        for ( size_t i = 0; i < 1000000; ++i )
+        {
+            const double z = generator();
+            uint64_t bits;
+            std::memcpy( &bits, &z, sizeof( bits ) );
+            hash = ( hash ^ bits ) * 0x100000001b3ULL;
+        }
+
+        return hash;
+    }
+}
+
+int main( int argc, char* argv[] )
+{
+    size_t samples = ( argc > 1 ) ? std::strtoull( argv[1], nullptr, 10 ) : 100000000;
+
+    if ( 0 == samples )
+    {
+        std::fprintf( stderr, "usage: %s [samples]\n", argv[0] );
+        return 1;
+    }
+
+    std::vector<Result> results;
+
+    {
+        std::default_random_engine engine( 1 );
+        std::normal_distribution<double> distribution( 0., 1. );
+        auto generator = [&engine, &distribution]() { return distribution( engine ); };
+        results.push_back( run( "std::normal_distribution", generator, samples ) );
+    }
+    {
+        NormalGenerator generator( 1 );
+        results.push_back( run( "NormalGenerator", generator, samples ) );
+    }
+
+    std::printf( "{\n  \"benchmark\": \"normal_bench\",\n" );
+    std::printf( "  \"checksum\": \"%016llx\",\n", static_cast<unsigned long long>( checksum() ) );
+    std::printf( "  \"results\": [\n" );
+
+    for ( size_t i = 0; i < results.size(); ++i )
+    {
+        const Result& r = results[i];
+        std::printf(
+            "    { \"generator\": \"%s\", \"samples\": %zu, \"nsPerSample\": %.3f, "
+            "\"mean\": %.6f, \"variance\": %.6f, \"skewness\": %.6f, \"kurtosis\": %.6f }%s\n",
+            r.generator.c_str(), r.samples, r.nsPerSample,
+            r.mean, r.variance, r.skewness, r.kurtosis,
+            ( i + 1 < results.size() ) ? "," : ""
+        );
+    }
+
+    std::printf( "  ]\n}\n" );
+
+    return 0;
+}
@@ -0,0 +1,300 @@
+/**************************************************************************
+ * Copyright (c) ERIGrid 2.0 (H2020 Programme Grant Agreement No. 870620) *
+ * All rights reserved.                                                   *
+ * See file LICENSE in the project root for license information.          *
+ **************************************************************************/
+
+// Micro-benchmark for the event queues of the pipeline FMUs.
+//
+// For each queue and each window size (number of events in flight), three workloads
+// are measured:
+//  - insert: push a window of events into an empty queue,
+//  - pop: remove a full window of events, earliest first,
+//  - mixed: steady state, i.e., pop the earliest event, advance the time to its timestamp
+//    and push a new event with a random delay (the window size stays constant).
+// Delays are drawn from the same distributions as in calculateDelay (default parameters
+// of the FMUs). The results are written to stdout in JSON format.
+//
+// Usage: pipeline_bench [max_window [ticks_per_second]]
+// (configure with -DCMAKE_BUILD_TYPE=Release for meaningful numbers)
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "fmi3PlatformTypes.h"
+#include "NormalGenerator.h"
+#include "DeterministicEventQueue.h"
+#include "ConfigurableEventQueue.h"
+#include "UnpredictableEventStack.h"
+
+namespace
+{
+    typedef TickTime::Ticks Ticks;
+
+    // Minimum number of operations per measurement (small windows are repeated).
+    const size_t minOperations = 1000000;
+
+    // Number of precomputed delays (power of two).
+    const size_t delayTableSize = size_t( 1 ) << 20;
+
+    // Delay distribution (seconds), see calculateDelay of the pipelines.
+    struct DelayDistribution {
+        const char* name;
+        fmi3Float64 mean;
+        fmi3Float64 stdDev;
+        fmi3Float64 min;
+    };
+
+    // Precompute delays (ticks), so that the random generator is not part of the measurement.
+    std::vector<Ticks> makeDelays( const DelayDistribution& dist, fmi3Int64 ticksPerSecond )
+    {
+        NormalGenerator generator( 4567 );
+
+        std::vector<Ticks> delays( delayTableSize );
+        for ( size_t i = 0; i < delayTableSize; ++i )
+        {
+            delays[i] = TickTime::fromSeconds( std::max( dist.mean + dist.stdDev * generator(), dist.min ), ticksPerSecond );
+        }
+
+        return delays;
+    }
+
+    // Adapter for the pipelines' event queues (EventScheduler).
+    template<typename EventQueue, typename Event>
+    struct SchedulerAdapter {
+
+        EventQueue queue;
+
+        explicit SchedulerAdapter( typename EventQueue::Backend backend ) { this->queue.setBackend( backend ); }
+
+        void push( Ticks t, fmi3Int32 id ) { this->queue.push( Event( t, id, 0 ) ); }
+
+        Ticks pop()
+        {
+            Ticks t = this->queue.top().timeStamp;
+            this->queue.pop();
+            return t;
+        }
+
+        void clear() { this->queue.release(); }
+    };
+
+    // Baseline: ordered set of heap-allocated events (the original queue implementation).
+    struct Event {
+        Ticks timeStamp;
+        fmi3Int32 msgId;
+
+        Event( Ticks t, fmi3Int32 m ) : timeStamp( t ), msgId( m ) {}
+    };
+
+    struct EventOrder {
+        bool operator() ( const Event* e1, const Event* e2 ) const { return e1->timeStamp < e2->timeStamp; }
+    };
+
+    struct MultisetAdapter {
+
+        std::multiset<Event*, EventOrder> queue;
+
+        void push( Ticks t, fmi3Int32 id ) { this->queue.insert( new Event( t, id ) ); }
+
+        Ticks pop()
+        {
+            std::multiset<Event*, EventOrder>::iterator it = this->queue.begin();
+            Ticks t = ( *it )->timeStamp;
+            delete *it;
+            this->queue.erase( it );
+            return t;
+        }
+
+        void clear()
+        {
+            while ( false == this->queue.empty() ) this->pop();
+        }
+    };
+
+    // Adapter for the unpredictable pipeline's event stack (FIFO, no timestamps).
+    struct StackAdapter {
+
+        UnpredictableEventStack::EventStack stack;
+
+        void push( Ticks, fmi3Int32 id ) { this->stack.push( UnpredictableEventStack::Event( id, 0 ) ); }
+
+        Ticks pop()
+        {
+            this->stack.pop();
+            return 0;
+        }
+
+        void clear() { this->stack.release(); }
+    };
+
+    struct Result {
+        std::string queue;
+        std::string backend;
+        std::string distribution;
+        std::string workload;
+        size_t window;
+        size_t operations;
+        double nsPerOperation;
+    };
+
+    double elapsedNs( std::chrono::steady_clock::time_point start )
+    {
+        return std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - start ).count();
+    }
+
+    // Accumulates popped values, so that the compiler cannot drop the measured work.
+    volatile Ticks sink = 0;
+
+    template<typename Adapter>
+    void run(
+        Adapter& adapter,
+        const char* queue,
+        const char* backend,
+        const char* distribution,
+        const std::vector<Ticks>& delays,
+        size_t window,
+        std::vector<Result>& results
+    ) {
+        const size_t mask = delays.size() - 1;
+        const size_t repetitions = std::max( size_t( 1 ), minOperations / window );
+        size_t d = 0;
+        Ticks check = 0;
+
+        // Events are never scheduled before the last removed event (as in the pipelines).
+        Ticks now = 0;
+
+        // Insert and pop (the queue is refilled for each repetition).
+        double insertNs = 0.;
+        double popNs = 0.;
+
+        for ( size_t r = 0; r < repetitions; ++r )
+        {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for ( size_t i = 0; i < window; ++i )
+            {
+                adapter.push( now + delays[ d++ & mask ], static_cast<fmi3Int32>( i ) );
+            }
+            insertNs += elapsedNs( start );
+
+            start = std::chrono::steady_clock::now();
+            for ( size_t i = 0; i < window; ++i )
+            {
+                now = adapter.pop();
+                check += now;
+            }
+            popNs += elapsedNs( start );
+        }
+
+        Result insert = { queue, backend, distribution, "insert", window, repetitions * window, insertNs / ( repetitions * window ) };
+        Result pop = { queue, backend, distribution, "pop", window, repetitions * window, popNs / ( repetitions * window ) };
+        results.push_back( insert );
+        results.push_back( pop );
+
+        // Steady state with a constant number of events in flight.
+        for ( size_t i = 0; i < window; ++i )
+        {
+            adapter.push( now + delays[ d++ & mask ], static_cast<fmi3Int32>( i ) );
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for ( size_t i = 0; i < minOperations; ++i )
+        {
+            now = adapter.pop();
+            adapter.push( now + delays[ d++ & mask ], static_cast<fmi3Int32>( i ) );
+        }
+        double mixedNs = elapsedNs( start );
+        check += now;
+
+        Result mixed = { queue, backend, distribution, "mixed", window, minOperations, mixedNs / minOperations };
+        results.push_back( mixed );
+
+        adapter.clear();
+        sink = sink + check;
+    }
+
+    void printJson( const std::vector<Result>& results, fmi3Int64 ticksPerSecond )
+    {
+        std::printf( "{\n  \"benchmark\": \"pipeline_bench\",\n" );
+        std::printf( "  \"ticksPerSecond\": %lld,\n", static_cast<long long>( ticksPerSecond ) );
+        std::printf( "  \"results\": [\n" );
+
+        for ( size_t i = 0; i < results.size(); ++i )
+        {
+            const Result& r = results[i];
+            std::printf(
+                "    { \"queue\": \"%s\", \"backend\": \"%s\", \"distribution\": \"%s\", \"workload\": \"%s\", "
+                "\"window\": %zu, \"operations\": %zu, \"nsPerOperation\": %.3f }%s\n",
+                r.queue.c_str(), r.backend.c_str(), r.distribution.c_str(), r.workload.c_str(),
+                r.window, r.operations, r.nsPerOperation,
+                ( i + 1 < results.size() ) ? "," : ""
+            );
+        }
+
+        std::printf( "  ]\n}\n" );
+    }
+}
+
+int main( int argc, char* argv[] )
+{
+    size_t maxWindow = ( argc > 1 ) ? std::strtoull( argv[1], nullptr, 10 ) : 10000000;
+    fmi3Int64 ticksPerSecond = ( argc > 2 ) ? std::strtoll( argv[2], nullptr, 10 ) : 1000000000;
+
+    if ( ( 0 == maxWindow ) || ( 1 > ticksPerSecond ) )
+    {
+        std::fprintf( stderr, "usage: %s [max_window [ticks_per_second]]\n", argv[0] );
+        return 1;
+    }
+
+    // Default parameters of Pipeline_deterministic (FMI3.xml) and delays in the order of
+    // seconds (former default of Pipeline_configurable).
+    const DelayDistribution deterministic = { "normal(100,50,min=30)", 100., 50., 30. };
+    const DelayDistribution configurable = { "normal(0.5,0.15,min=0.1)", .5, .15, .1 };
+
+    const std::vector<Ticks> deterministicDelays = makeDelays( deterministic, ticksPerSecond );
+    const std::vector<Ticks> configurableDelays = makeDelays( configurable, ticksPerSecond );
+
+    typedef SchedulerAdapter<DeterministicEventQueue::EventQueue, DeterministicEventQueue::Event> DeterministicAdapter;
+    typedef SchedulerAdapter<ConfigurableEventQueue::EventQueue, ConfigurableEventQueue::Event> ConfigurableAdapter;
+
+    std::vector<Result> results;
+
+    for ( size_t window = 100; window <= maxWindow; window *= 10 )
+    {
+        {
+            DeterministicAdapter heap( DeterministicEventQueue::EventQueue::heap );
+            run( heap, "DeterministicEventQueue", "heap", deterministic.name, deterministicDelays, window, results );
+        }
+        {
+            DeterministicAdapter wheel( DeterministicEventQueue::EventQueue::timingWheel );
+            run( wheel, "DeterministicEventQueue", "timingWheel", deterministic.name, deterministicDelays, window, results );
+        }
+        {
+            ConfigurableAdapter heap( ConfigurableEventQueue::EventQueue::heap );
+            run( heap, "ConfigurableEventQueue", "heap", configurable.name, configurableDelays, window, results );
+        }
+        {
+            ConfigurableAdapter wheel( ConfigurableEventQueue::EventQueue::timingWheel );
+            run( wheel, "ConfigurableEventQueue", "timingWheel", configurable.name, configurableDelays, window, results );
+        }
+        {
+            MultisetAdapter baseline;
+            run( baseline, "baseline", "std::multiset", deterministic.name, deterministicDelays, window, results );
+        }
+        {
+            StackAdapter stack;
+            run( stack, "UnpredictableEventStack", "ringBuffer", "none", deterministicDelays, window, results );
+        }
+    }
+
+    printJson( results, ticksPerSecond );
+
+    return 0;
+}
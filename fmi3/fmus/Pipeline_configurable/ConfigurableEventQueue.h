@@ -7,51 +7,63 @@
 #ifndef ConfigurableEventQueue_h
 #define ConfigurableEventQueue_h
 
-#include <set>
+#include "EventScheduler.h"
+#include "TickTime.h"
 
 namespace ConfigurableEventQueue
 {
-	typedef fmi3Float64 TimeStamp;
+	typedef TickTime::Ticks TimeStamp;
 	typedef fmi3Float64 Tolerance;
 	typedef fmi3Int32 MessageID;
 	typedef fmi3Int32* Receiver;
 	typedef fmi3Clock* ReceiverClock;
-    
+	typedef fmi3UInt16 Channel;
+
+	// An output channel is an output variable and its associated output clock.
+	struct OutputChannel {
+		Receiver receiver;
+		ReceiverClock clock;
+	};
+
+	// Events are compact 16-byte records. The output variable and clock are resolved from
+	// the channel index through the pipeline's table of output channels.
 	struct Event {
 
-		TimeStamp timeStamp; // Each event is associated with a timestamp.
+		TimeStamp timeStamp; // Each event is associated with a timestamp (in ticks).
 		MessageID msgId; // Each event is associated with a message ID.
-		Receiver receiver; //TODO: to be removed
-        ReceiverClock clock; //TODO: to be removed
+		Channel channel; // Each event is associated with an output channel.
 
 		// Struct constructor.
 		Event(
             TimeStamp t,
             MessageID m,
-            Receiver r,
-            ReceiverClock c
+            Channel c
         ) :
             timeStamp( t ),
             msgId( m ),
-            receiver( r ),
-            clock( c )
+            channel( c )
         {}
 	};
 
-    static Tolerance tolerance = 1e-9;
+	static_assert( sizeof( Event ) == 16, "events are expected to be 16-byte records" );
+
+	// Default precision for matching communication points (seconds). Each pipeline instance
+	// keeps its own tolerance, which may be overridden in enterInitializationMode.
+	static const Tolerance defaultTolerance = 1e-9;
 
 	// This functor defines that events are sorted in the event queue according to their timestamp.
+	// Timestamps are integer ticks, hence the comparison is exact (strict weak ordering).
 	struct EventOrder {
 		bool operator() (
-            const Event* e1,
-            const Event* e2
+            const Event& e1,
+            const Event& e2
         ) const {
-			return e1->timeStamp < e2->timeStamp - ConfigurableEventQueue::tolerance;
+			return e1.timeStamp < e2.timeStamp;
 		}
 	};
 
-	// This is the definition of the event queue.
-	typedef std::set<Event*, EventOrder> EventQueue;
+	// This is the definition of the event queue (events are stored by value).
+	typedef EventScheduler<Event, EventOrder> EventQueue;
 }
 
 #endif // ConfigurableEventQueue_h
@@ -7,9 +7,12 @@
 #ifndef NetworkConfiguration_h
 #define NetworkConfiguration_h
 #include "rapidjson/document.h"
+#include <cmath>
 #include <iostream>
 #include <map>
+#include <stdexcept>
 #include <string>
+#include <vector>
 #include <fstream>
 #include <sstream>
 
@@ -23,6 +26,11 @@
 #define ATTR_PIPEDLY "delay"
 #define ATTR_PIPEJTR "jitter"
 #define ATTR_PIPELSS "loss"
+#define ATTR_PIPEBST "burstStart"
+#define ATTR_PIPEBND "burstEnd"
+#define ATTR_PIPEBLS "burstLoss"
+#define ATTR_PIPEBDW "bandwidth"
+#define ATTR_PIPEBUF "buffer"
 #define ATTR_STARTNODE "startNode"
 #define ATTR_ENDNODE "endNode"
 
@@ -46,9 +54,13 @@ class NetworkNode {
         
         void addOutput(std::string pipe) {outPipes.push_back(pipe);}
         
-        bool isInputNode() {return (!outPipes.empty() && inPipes.empty());}
+        bool isInputNode() const {return (!outPipes.empty() && inPipes.empty());}
         
-        bool isOutputNode() {return (!inPipes.empty() && outPipes.empty());}
+        bool isOutputNode() const {return (!inPipes.empty() && outPipes.empty());}
+        
+        const std::vector<std::string>& getInputPipes() const {return inPipes;}
+        
+        const std::vector<std::string>& getOutputPipes() const {return outPipes;}
 
 };
 
@@ -64,22 +76,69 @@ class NetworkPipeline {
         double delay;
         double jitter;
         double loss;
+        double burstStart;
+        double burstEnd;
+        double burstLoss;
+        double bandwidth;
+        double buffer;
         fmi3Int32* receiver;
         fmi3Clock* receiverClock;
         
     public:
         
-        NetworkPipeline(std::string n, std::string s, std::string e, std::string d, std::string j, std::string l) {
+        NetworkPipeline(std::string n, std::string s, std::string e, std::string d, std::string j, std::string l,
+                        std::string bs="0", std::string be="1", std::string bl="1",
+                        std::string bw="0", std::string bf="inf") {
             pipeName=n;
             startNodeName=s;
             endNodeName=e;
-            delay=stod(d);
-            jitter=stod(j);
-            loss=stod(l);
+            try {
+                delay=stod(d);
+                jitter=stod(j);
+                loss=stod(l);
+                burstStart=stod(bs);
+                burstEnd=stod(be);
+                burstLoss=stod(bl);
+                bandwidth=stod(bw);
+                buffer=stod(bf);
+            }
+            catch (std::logic_error&) {
+                throw std::runtime_error(ERROR_PREFIX "Pipeline: delay, jitter, loss, burst and link parameters must be numbers");
+            }
+            if (!(delay>=0.) || !(jitter>=0.)) throw std::runtime_error(ERROR_PREFIX "Pipeline: delay and jitter must not be negative");
+            if (!(loss>=0.) || !(loss<=1.)) throw std::runtime_error(ERROR_PREFIX "Pipeline: loss must be a probability");
+            if (!(burstStart>=0.) || !(burstStart<=1.) || !(burstEnd>=0.) || !(burstEnd<=1.) || !(burstLoss>=0.) || !(burstLoss<=1.))
+                throw std::runtime_error(ERROR_PREFIX "Pipeline: burst parameters must be probabilities");
+            if (!(bandwidth>=0.) || std::isinf(bandwidth) || !(buffer>=0.)) throw std::runtime_error(ERROR_PREFIX "Pipeline: bandwidth and buffer must not be negative");
             receiver=NULL;
             receiverClock=NULL;
         }
         
+        std::string getPipeName() const {return pipeName;}
+        std::string getStartNodeName() const {return startNodeName;}
+        std::string getEndNodeName() const {return endNodeName;}
+        
+        // Mean delay and jitter (standard deviation of the delay) in seconds, loss probability.
+        double getDelay() const {return delay;}
+        double getJitter() const {return jitter;}
+        double getLoss() const {return loss;}
+        
+        // Gilbert-Elliott model of burst losses: a pipe is either in the good state (loss
+        // probability "loss") or in the bad state (loss probability "burstLoss"). Before a
+        // message crosses the pipe, the state changes from good to bad with probability
+        // "burstStart" and from bad to good with probability "burstEnd". Without these
+        // (optional) attributes, the pipe never leaves the good state.
+        double getBurstStart() const {return burstStart;}
+        double getBurstEnd() const {return burstEnd;}
+        double getBurstLoss() const {return burstLoss;}
+        
+        // Link model: the pipe transmits "bandwidth" bytes per second and queues messages
+        // in a FIFO buffer of "buffer" bytes (including the message in transmission),
+        // messages that do not fit are dropped. Without these (optional) attributes, the
+        // capacity and the buffer are unlimited (bandwidth 0).
+        double getBandwidth() const {return bandwidth;}
+        double getBuffer() const {return buffer;}
+        
         bool connectNodes(std::map<std::string,NetworkNode>* nodes) {
             startNode=NULL;
             endNode=NULL;
@@ -106,6 +165,7 @@ class NetworkConfiguration {
     std::string networkName;
     std::string formatVersion;
     std::map<std::string,NetworkNode> nodes;
+    std::vector<std::string> nodeNames;
     std::map<std::string,NetworkPipeline> pipelines;
     
   public:
@@ -113,6 +173,12 @@ class NetworkConfiguration {
     std::string getNetworkName() {return networkName;}
     std::string getFormatVersion() {return formatVersion;}
     
+    // Nodes in the order of their first appearance in the configuration file, which is the
+    // order of their variables in FMI3.xml (see generate_fmi3xml.py).
+    const std::vector<std::string>& getNodeNames() const {return nodeNames;}
+    const std::map<std::string,NetworkNode>& getNodes() const {return nodes;}
+    const std::map<std::string,NetworkPipeline>& getPipelines() const {return pipelines;}
+    
     static NetworkConfiguration parse(fmi3String filename) {
         std::ifstream myFile(filename);
         if (!myFile.good()) throw std::runtime_error("Could not open network configuration file." );
@@ -154,25 +220,19 @@ class NetworkConfiguration {
             std::string startnode=v_stn.GetString();
             std::map<std::string,NetworkNode>::iterator nn= retval.nodes.find(startnode);
             if ( nn == retval.nodes.end() ) {
-                NetworkNode nx(startnode);
-                retval.nodes.insert(std::pair<std::string,NetworkNode>(startnode,nx));
-                nx.addOutput(pipename);
-            }
-            else {
-                nn->second.addOutput(pipename);
+                nn=retval.nodes.insert(std::pair<std::string,NetworkNode>(startnode,NetworkNode(startnode))).first;
+                retval.nodeNames.push_back(startnode);
             }
+            nn->second.addOutput(pipename);
             rapidjson::Value& v_enn=pipe[ATTR_ENDNODE];
             if (!v_enn.IsString()) throw std::runtime_error(ERROR_PREFIX "no pipeline end node specified.");
             std::string endnode=v_enn.GetString();
             nn= retval.nodes.find(endnode);
             if ( nn == retval.nodes.end() ) {
-                NetworkNode nx(endnode);
-                retval.nodes.insert(std::pair<std::string,NetworkNode>(endnode,nx));
-                nx.addInput(pipename);
-            }
-            else {
-                nn->second.addInput(pipename);
+                nn=retval.nodes.insert(std::pair<std::string,NetworkNode>(endnode,NetworkNode(endnode))).first;
+                retval.nodeNames.push_back(endnode);
             }
+            nn->second.addInput(pipename);
             
             rapidjson::Value& v_dly=pipe[ATTR_PIPEDLY];
             if (!v_dly.IsString()) throw std::runtime_error(ERROR_PREFIX "no pipeline delay specified.");
@@ -184,7 +244,17 @@ class NetworkConfiguration {
             if (!v_lss.IsString()) throw std::runtime_error(ERROR_PREFIX "no pipeline loss specified.");
             std::string pipeloss=v_lss.GetString();
             
-            NetworkPipeline px(pipename,startnode,endnode,pipedelay,pipejitter,pipeloss);
+            //optional parameters of the burst loss model and the link model
+            std::string optional[5]={"0","1","1","0","inf"};
+            const char* optionalattr[5]={ATTR_PIPEBST,ATTR_PIPEBND,ATTR_PIPEBLS,ATTR_PIPEBDW,ATTR_PIPEBUF};
+            for (int b=0; b<5; ++b) {
+                if (!pipe.HasMember(optionalattr[b])) continue;
+                rapidjson::Value& v_opt=pipe[optionalattr[b]];
+                if (!v_opt.IsString()) throw std::runtime_error(ERROR_PREFIX "burst and link parameters must be strings.");
+                optional[b]=v_opt.GetString();
+            }
+            
+            NetworkPipeline px(pipename,startnode,endnode,pipedelay,pipejitter,pipeloss,optional[0],optional[1],optional[2],optional[3],optional[4]);
             retval.pipelines.insert(std::pair<std::string,NetworkPipeline>(pipename,px));
             
             
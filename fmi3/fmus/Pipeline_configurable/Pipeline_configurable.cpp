@@ -7,7 +7,12 @@
 #include "Pipeline_configurable.h"
 
 #include <limits>
+#include <cmath>
+#include <cstdlib>
 #include <algorithm>
+#include <functional>
+#include <map>
+#include <queue>
 #include <stdexcept>
 #include <iostream>
 #include <string>
@@ -19,6 +24,36 @@
 
 using namespace ConfigurableEventQueue;
 
+constexpr VariableDescription<Pipeline_configurable, fmi3Int32> Pipeline_configurable::int32Variables_[] = {
+    scalarVariable( vrRandomSeed_, &Pipeline_configurable::randomSeed_, parameterVariable ),
+    scalarVariable( vrTicksPerSecond_, &Pipeline_configurable::ticksPerSecond_, parameterVariable ),
+    scalarVariable( vrEventScheduler_, &Pipeline_configurable::eventScheduler_, parameterVariable ),
+    scalarVariable( vrMessageSize_, &Pipeline_configurable::messageSize_, parameterVariable )
+};
+
+constexpr VariableDescription<Pipeline_configurable, fmi3Float64> Pipeline_configurable::float64Variables_[] = {
+    scalarVariable( vrMeanDelay_, &Pipeline_configurable::meanDelay_, outputVariable ),
+    scalarVariable( vrMaxDelay_, &Pipeline_configurable::maxDelay_, outputVariable ),
+    scalarVariable( vrLastDeliveryTime_, &Pipeline_configurable::lastDeliveryTime_, outputVariable )
+};
+
+constexpr VariableDescription<Pipeline_configurable, fmi3UInt64> Pipeline_configurable::uInt64Variables_[] = {
+    scalarVariable( vrTraceCapacity_, &Pipeline_configurable::traceCapacity_, parameterVariable ),
+    scalarVariable( vrQueueDepth_, &Pipeline_configurable::queueDepth_, outputVariable ),
+    scalarVariable( vrMessagesInFlight_, &Pipeline_configurable::messagesInFlight_, outputVariable ),
+    scalarVariable( vrMessagesSent_, &Pipeline_configurable::messagesSent_, outputVariable ),
+    scalarVariable( vrMessagesDelivered_, &Pipeline_configurable::messagesDelivered_, outputVariable ),
+    scalarVariable( vrMessagesDropped_, &Pipeline_configurable::messagesDropped_, outputVariable )
+};
+
+constexpr VariableDescription<Pipeline_configurable, fmi3Clock> Pipeline_configurable::clockVariables_[] = {
+    scalarVariable( vrDummyClock_, &Pipeline_configurable::dummyClock_, outputVariable )
+};
+
+constexpr VariableDescription<Pipeline_configurable, std::string> Pipeline_configurable::stringVariables_[] = {
+    scalarVariable( vrDelayDistribution_, &Pipeline_configurable::delayDistribution_, parameterVariable )
+};
+
 Pipeline_configurable::Pipeline_configurable(
     fmi3String instanceName,
     fmi3String instantiationToken,
@@ -30,8 +65,8 @@ Pipeline_configurable::Pipeline_configurable(
     const fmi3ValueReference requiredIntermediateVariables[],
     size_t nRequiredIntermediateVariables,
     fmi3InstanceEnvironment instanceEnvironment,
-    fmi3CallbackLogMessage logMessage,
-    fmi3CallbackIntermediateUpdate intermediateUpdate
+    fmi3LogMessageCallback logMessage,
+    fmi3IntermediateUpdateCallback intermediateUpdate
 ) :
     InstanceBase(
         instanceName,
@@ -47,16 +82,26 @@ Pipeline_configurable::Pipeline_configurable(
         logMessage,
         intermediateUpdate
     ),
-    in_( 0 ),
-    out_( 0 ),
+    dummyClock_( fmi3ClockInactive ),
     randomSeed_( 1 ),
-    randomMean_( 0.5 ),
-    randomStdDev_( 0.15 ),
-    randomMin_( 0.1 ),
-    tolerance_( ConfigurableEventQueue::tolerance ),
-    nextEventTime_( std::numeric_limits<fmi3Float64>::max() ),
-    eventQueue_(),
-    currentEvent_( eventQueue_.end() )
+    ticksPerSecond_( 1000000000 ),
+    eventScheduler_( EventQueue::heap ),
+    messageSize_( 1500 ),
+    traceCapacity_( 0 ),
+    queueDepth_( 0 ),
+    messagesInFlight_( 0 ),
+    messagesSent_( 0 ),
+    messagesDelivered_( 0 ),
+    messagesDropped_( 0 ),
+    meanDelay_( 0. ),
+    maxDelay_( 0. ),
+    lastDeliveryTime_( 0. ),
+    startTime_( 0. ),
+    syncTime_( 0 ),
+    nextEventTime_( TickTime::never ),
+    tolerance_( ConfigurableEventQueue::defaultTolerance ),
+    toleranceTicks_( 0 ),
+    eventQueue_()
 {
     if ( fmi3False == this->getEventModeUsed() )
     {
@@ -73,17 +118,240 @@ Pipeline_configurable::Pipeline_configurable(
         throw std::runtime_error( "Wrong GUID (instantiation token)." );
     }
 
-    this->parseNetworkConfig(resourceLocation);
-    
+    // Network topology (file network.json in the resource directory).
+    this->parseNetworkConfig( this->getResourceFile( "network.json" ) );
+
+    // Bind the variables of the FMU (value references must match FMI3.xml).
+    static_assert( hasIncreasingValueReferences( int32Variables_ ), "int32 variables must be sorted by value reference" );
+    this->int32Table_.bind( this, int32Variables_ );
+    static_assert( hasIncreasingValueReferences( float64Variables_ ), "float64 variables must be sorted by value reference" );
+    this->float64Table_.bind( this, float64Variables_ );
+    static_assert( hasIncreasingValueReferences( uInt64Variables_ ), "uInt64 variables must be sorted by value reference" );
+    this->uInt64Table_.bind( this, uInt64Variables_ );
+    static_assert( hasIncreasingValueReferences( clockVariables_ ), "clock variables must be sorted by value reference" );
+    this->clockTable_.bind( this, clockVariables_ );
+    static_assert( hasIncreasingValueReferences( stringVariables_ ), "string variables must be sorted by value reference" );
+    this->stringTable_.bind( this, stringVariables_ );
+
+    // Variables of the input and output nodes (same value references as generate_fmi3xml.py).
+    for ( size_t i = 0; i < this->inputs_.size(); ++i )
+    {
+        const fmi3ValueReference vr = vrFirstInput_ + static_cast<fmi3ValueReference>( 2 * i );
+        this->int32Table_.add( vr, &this->inputs_[i].value, inputVariable );
+        this->clockTable_.add( vr + 1, &this->inputs_[i].clock, inputVariable );
+    }
+
+    for ( size_t j = 0; j < this->outputs_.size(); ++j )
+    {
+        const fmi3ValueReference vr = vrFirstOutput_ + static_cast<fmi3ValueReference>( 2 * j );
+        this->int32Table_.add( vr, &this->outputs_[j].value, outputVariable );
+        this->clockTable_.add( vr + 1, &this->outputs_[j].clock, outputVariable );
+
+        // Channel j: variable and clock of output node j.
+        OutputChannel out = { &this->outputs_[j].value, &this->outputs_[j].clock };
+        this->outputChannels_.push_back( out );
+    }
+
     this->logDebug(
-        "successfully initialized class %s", "Pipeline_configurable"
+        logInstance, "successfully initialized class %s", "Pipeline_configurable"
     );
 }
 
-bool Pipeline_configurable::parseNetworkConfig(fmi3String filename) {
-    NetworkConfiguration nc=NetworkConfiguration::parse(filename);
-    std::cout << nc.getNetworkName() << std::endl;
-    return false;
+void
+Pipeline_configurable::parseNetworkConfig( const std::string& fileName )
+{
+    NetworkConfiguration network = NetworkConfiguration::parse( fileName.c_str() );
+
+    // Nodes are numbered in the order of network.json, pipes become hops between nodes.
+    struct Hop {
+        size_t to;
+        uint32_t pipe;
+        double delay;
+        double variance;
+    };
+
+    const std::vector<std::string>& names = network.getNodeNames();
+    std::map<std::string, size_t> index;
+    for ( size_t n = 0; n < names.size(); ++n ) index[ names[n] ] = n;
+
+    std::vector<std::vector<Hop>> hops( names.size() );
+    this->pipeLoss_.clear();
+    this->pipeLinks_.clear();
+    for ( const auto& p : network.getPipelines() )
+    {
+        const NetworkPipeline& pipe = p.second;
+        Hop hop = {
+            index[ pipe.getEndNodeName() ], static_cast<uint32_t>( this->pipeLoss_.size() ),
+            pipe.getDelay(), pipe.getJitter() * pipe.getJitter()
+        };
+        hops[ index[ pipe.getStartNodeName() ] ].push_back( hop );
+
+        PipeLoss loss = { pipe.getBurstStart(), pipe.getBurstEnd(), pipe.getLoss(), pipe.getBurstLoss() };
+        this->pipeLoss_.push_back( loss );
+
+        PipeLink link = { pipe.getBandwidth(), pipe.getBuffer(), 0, TickTime::never };
+        this->pipeLinks_.push_back( link );
+
+        if ( 0. < loss.goodToBad )
+        {
+            // Stationary probability of the bad state and mean loss probability.
+            const double bad = loss.goodToBad / ( loss.goodToBad + loss.badToGood );
+            this->logDebug(
+                logInstance, "pipe %s: burst losses, bad state %g of the time, mean loss %g",
+                pipe.getPipeName().c_str(), bad, ( 1. - bad ) * loss.lossGood + bad * loss.lossBad
+            );
+        }
+    }
+
+    // All pipes start in the good state with empty queues.
+    this->pipeBad_.assign( this->pipeLoss_.size(), 0 );
+    this->linkBusyUntil_.assign( this->pipeLinks_.size(), 0 );
+
+    std::vector<size_t> inputNodes;
+    std::vector<size_t> outputNodes;
+    for ( size_t n = 0; n < names.size(); ++n )
+    {
+        const NetworkNode& node = network.getNodes().at( names[n] );
+        if ( node.isInputNode() ) inputNodes.push_back( n );
+        if ( node.isOutputNode() ) outputNodes.push_back( n );
+    }
+
+    if ( ( inputNodes.size() > maxNodes_ ) || ( outputNodes.size() > maxNodes_ ) )
+    {
+        throw std::runtime_error( "Network configuration file: too many input or output nodes." );
+    }
+
+    this->logDebug(
+        logInstance, "network \"%s\": %zu nodes, %zu pipes, %zu inputs, %zu outputs",
+        network.getNetworkName().c_str(), names.size(), network.getPipelines().size(),
+        inputNodes.size(), outputNodes.size()
+    );
+
+    const NodeVariables initial = { 0, fmi3ClockInactive };
+    this->inputs_.assign( inputNodes.size(), initial );
+    this->outputs_.assign( outputNodes.size(), initial );
+
+    // The route from an input to an output node is the path with the smallest mean delay
+    // (Dijkstra). Along the path, the mean delays and the variances of the pipes add up
+    // (independent jitter). The routes of an input node form a tree, whose pipes are
+    // stored in the order in which Dijkstra's algorithm reaches them (parents first).
+    // Pipes that are not on the route to any output node are removed from the tree, so
+    // that messages do not cross them (i.e., draw losses or occupy links) for nothing.
+    const Route unreachable = { false, 0., 0. };
+    this->routes_.assign( inputNodes.size() * outputNodes.size(), unreachable );
+    this->destinations_.clear();
+    this->destinationCrossing_.clear();
+    this->firstDestination_.assign( 1, 0 );
+    this->crossings_.clear();
+    this->firstCrossing_.assign( 1, 0 );
+
+    const double infinity = std::numeric_limits<double>::infinity();
+    std::vector<double> delay( names.size() );
+    std::vector<double> variance( names.size() );
+    std::vector<size_t> previous( names.size() );
+    std::vector<uint32_t> lastPipe( names.size() );
+    std::vector<uint32_t> crossing( names.size() );
+
+    typedef std::pair<double, size_t> Candidate;
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> candidates;
+
+    for ( size_t i = 0; i < inputNodes.size(); ++i )
+    {
+        std::fill( delay.begin(), delay.end(), infinity );
+        delay[ inputNodes[i] ] = 0.;
+        variance[ inputNodes[i] ] = 0.;
+        crossing[ inputNodes[i] ] = noParent;
+        candidates.push( Candidate( 0., inputNodes[i] ) );
+
+        const size_t treeStart = this->crossings_.size();
+
+        while ( false == candidates.empty() )
+        {
+            const Candidate c = candidates.top();
+            candidates.pop();
+            if ( c.first > delay[ c.second ] ) continue;
+
+            // The node is reached, add the last pipe of its route to the tree (after the
+            // pipe that leads to its start node).
+            if ( c.second != inputNodes[i] )
+            {
+                crossing[ c.second ] = static_cast<uint32_t>( this->crossings_.size() - treeStart );
+
+                const Crossing x = {
+                    lastPipe[ c.second ], crossing[ previous[ c.second ] ], delay[ previous[ c.second ] ]
+                };
+                this->crossings_.push_back( x );
+            }
+
+            for ( const Hop& hop : hops[ c.second ] )
+            {
+                if ( c.first + hop.delay < delay[ hop.to ] )
+                {
+                    delay[ hop.to ] = c.first + hop.delay;
+                    variance[ hop.to ] = variance[ c.second ] + hop.variance;
+                    previous[ hop.to ] = c.second;
+                    lastPipe[ hop.to ] = hop.pipe;
+                    candidates.push( Candidate( delay[ hop.to ], hop.to ) );
+                }
+            }
+        }
+
+        // Mark the pipes on the routes to the reachable output nodes, then remove all others
+        // from the tree (parents stay before their children).
+        const size_t treeSize = this->crossings_.size() - treeStart;
+        std::vector<uint32_t> kept( treeSize );
+        std::vector<uint8_t> needed( treeSize, 0 );
+
+        for ( size_t j = 0; j < outputNodes.size(); ++j )
+        {
+            if ( infinity == delay[ outputNodes[j] ] ) continue;
+
+            for ( uint32_t x = crossing[ outputNodes[j] ]; ( noParent != x ) && ( 0 == needed[x] ); x = this->crossings_[ treeStart + x ].parent )
+            {
+                needed[x] = 1;
+            }
+        }
+
+        uint32_t keptSize = 0;
+        for ( size_t x = 0; x < treeSize; ++x )
+        {
+            if ( 0 == needed[x] ) continue;
+
+            Crossing c = this->crossings_[ treeStart + x ];
+            if ( noParent != c.parent ) c.parent = kept[ c.parent ];
+
+            kept[x] = keptSize;
+            this->crossings_[ treeStart + keptSize++ ] = c;
+        }
+
+        this->crossings_.resize( treeStart + keptSize );
+
+        for ( size_t j = 0; j < outputNodes.size(); ++j )
+        {
+            if ( infinity == delay[ outputNodes[j] ] ) continue;
+
+            Route& route = this->routes_[ i * outputNodes.size() + j ];
+            route.reachable = true;
+            route.delay = delay[ outputNodes[j] ];
+            route.jitter = std::sqrt( variance[ outputNodes[j] ] );
+
+            this->destinations_.push_back( static_cast<Channel>( j ) );
+            uint32_t last = crossing[ outputNodes[j] ];
+            if ( noParent != last ) last = kept[ last ];
+            this->destinationCrossing_.push_back( last );
+
+            this->logDebug(
+                logInstance, "route %s -> %s: delay %g s, jitter %g s",
+                names[ inputNodes[i] ].c_str(), names[ outputNodes[j] ].c_str(),
+                route.delay, route.jitter
+            );
+        }
+
+        this->firstDestination_.push_back( this->destinations_.size() );
+        this->firstCrossing_.push_back( this->crossings_.size() );
+        this->crossed_.resize( std::max( this->crossed_.size(), this->crossings_.size() - treeStart ) );
+        this->queueing_.resize( this->crossed_.size() );
+    }
 }
 
 fmi3Status
@@ -96,13 +364,12 @@ Pipeline_configurable::enterInitializationMode(
 ) {
     this->setMode( initializationMode );
 
-    // Set internal time to simulation start time.
-    this->syncTime_ = startTime;
+    // Simulation start time, converted to ticks when the time base is fixed.
+    this->startTime_ = startTime;
 
-    // Adjust tolerances for determining if two timestamps are the same.
+    // Adjust the precision for matching the importer's communication points.
     if ( fmi3True == toleranceDefined )
     {
-        ConfigurableEventQueue::tolerance = tolerance;
         this->tolerance_ = tolerance;
     }
 
@@ -112,8 +379,34 @@ Pipeline_configurable::enterInitializationMode(
 fmi3Status
 Pipeline_configurable::exitInitializationMode()
 {
+    // Time base must have a positive resolution.
+    if ( 1 > this->ticksPerSecond_ )
+    {
+        this->logError( "Invalid number of ticks per second: %d", this->ticksPerSecond_ );
+        return fmi3Error;
+    }
+
+    if ( false == EventQueue::isValidBackend( this->eventScheduler_ ) )
+    {
+        this->logError( "Invalid event queue backend: %d", this->eventScheduler_ );
+        return fmi3Error;
+    }
+
+    if ( 1 > this->messageSize_ )
+    {
+        this->logError( "Invalid message size: %d", this->messageSize_ );
+        return fmi3Error;
+    }
+
+    // Select the event queue backend.
+    this->eventQueue_.setBackend( static_cast<EventQueue::Backend>( this->eventScheduler_ ) );
+
     this->setMode( stepMode );
 
+    // Set internal time to simulation start time.
+    this->syncTime_ = this->toTicks( this->startTime_ );
+    this->toleranceTicks_ = this->toTicks( this->tolerance_ );
+
 	// Random generator seed has to be a positive non-zero integer.
 	if ( 1 > this->randomSeed_ )
     {
@@ -123,262 +416,106 @@ Pipeline_configurable::exitInitializationMode()
     // Set random generator seed.
     this->generator_.seed( this->randomSeed_ );
 
-    // Initialize random number distribution.
-    this->distribution_ = std::normal_distribution<fmi3Float64>(
-        this->randomMean_,
-        this->randomStdDev_
-    );
-
-    return fmi3OK;
-}
+    // All pipes start in the good state with empty queues.
+    std::fill( this->pipeBad_.begin(), this->pipeBad_.end(), 0 );
+    std::fill( this->linkBusyUntil_.begin(), this->linkBusyUntil_.end(), this->syncTime_ );
 
-fmi3Status 
-Pipeline_configurable::enterEventMode(
-    fmi3Boolean stepEvent,
-    fmi3Boolean stateEvent,
-    const fmi3Int32 rootsFound[],
-    size_t nEventIndicators,
-    fmi3Boolean timeEvent
-) {
-    this->setMode( eventMode );
-    
-    // This is a time event that was previously signaled by function doStep.
-    // This means that a new message is available to be received by the importer.
-    if ( fmi3True == timeEvent ) 
+    // Transmission times of the links (depend on the time base and the message size).
+    for ( PipeLink& link : this->pipeLinks_ )
     {
-        *( *this->currentEvent_ )->receiver = ( *this->currentEvent_ )->msgId;
-        *( *this->currentEvent_ )->clock = fmi3ClockActive;
+        if ( 0. < link.bandwidth )
+        {
+            link.transmission = this->toTicks( this->messageSize_ / link.bandwidth );
+            link.maxBacklog = std::isinf( link.buffer ) ? TickTime::never : this->toTicks( link.buffer / link.bandwidth );
+        }
     }
 
-    return fmi3OK;
-}
-
-fmi3Status
-Pipeline_configurable::reset()
-{
-    this->eventQueue_.clear();
-    this->currentEvent_ = this->eventQueue_.end();
-    this->nextEventTime_ = std::numeric_limits<fmi3Float64>::max();
-
-    return fmi3OK;
-}
-
-fmi3Status
-Pipeline_configurable::getInt32(
-    const fmi3ValueReference valueReferences[],
-    size_t nValueReferences,
-    fmi3Int32 values[],
-    size_t nValues
-) {
-    if ( nValueReferences != nValues ) {
-        this->logError(
-            "%s %s",
-            "This FMU only supports scalar variables.",
-            "The number of value references and values must match!"
-        );
-        return fmi3Error;
+    // Build the alias table of the empirical delay distribution.
+    if ( this->delayDistribution_.empty() )
+    {
+        this->delayTable_.clear();
     }
-
-    fmi3Status status = fmi3OK;
-    const fmi3ValueReference* vr;
-    fmi3Int32* v;
-
-    for (
-        vr = valueReferences, v = values;
-        vr != valueReferences + nValues, v != values + nValues;
-        ++vr, ++v
-    ) {
-        switch ( *vr ) {
-            case this->vrOut_:
-                *v = this->out_;
-                this->logDebug( "%d => get %d", *vr, this->out_ );
-                break;
-            default:
-                this->logError( "Invalid value reference: %d", *vr );
-                status = fmi3Error;
+    else
+    {
+        std::string error;
+        if ( false == this->delayTable_.load( this->getResourceFile( this->delayDistribution_ ), error ) )
+        {
+            this->logError( "Invalid delay distribution: %s", error.c_str() );
+            return fmi3Error;
         }
-    }
 
-    return status;
-}
-
-fmi3Status
-Pipeline_configurable::getClock(
-    const fmi3ValueReference valueReferences[],
-    size_t nValueReferences,
-    fmi3Clock values[],
-    size_t nValues
-) {
-    if ( nValueReferences != nValues ) {
-        this->logError(
-            "%s %s",
-            "This FMU only supports scalar variables.",
-            "The number of value references and values must match!"
+        this->logDebug(
+            logInstance, "empirical delay distribution with %zu bins (mean %g s)",
+            this->delayTable_.size(), this->delayTable_.mean()
         );
-        return fmi3Error;
     }
 
-    fmi3Status status = fmi3OK;
-    const fmi3ValueReference* vr;
-    fmi3Clock* v;
-
-    for (
-        vr = valueReferences, v = values;
-        vr != valueReferences + nValues, v != values + nValues;
-        ++vr, ++v
-    ) {
-        switch ( *vr ) {
-            case this->vrOutClock_:
-                *v = this->outClock_;
-                this->logDebug( "%d => get clock %d", *vr, this->outClock_ );
-                break;
-            default:
-                this->logError( "Invalid value reference: %d", *vr );
-                status = fmi3Error;
+    // Open the message trace "<instance name>.trace" in the directory given by the environment
+    // variable FMU_TRACE_DIR (default: resource directory).
+    if ( 0 < this->traceCapacity_ )
+    {
+        const std::string path = this->getOutputFile( this->getInstanceName() + ".trace", "FMU_TRACE_DIR" );
+
+        if ( false == this->trace_.open( path, this->traceCapacity_, this->ticksPerSecond_ ) )
+        {
+            this->logError( "Cannot create message trace %s", path.c_str() );
+            return fmi3Error;
         }
     }
 
-    return status;
+    return fmi3OK;
 }
 
-fmi3Status
-Pipeline_configurable::setInt32(
-    const fmi3ValueReference valueReferences[],
-    size_t nValueReferences,
-    const fmi3Int32 values[],
-    size_t nValues
-) {
-    if ( nValueReferences != nValues ) {
-        this->logError(
-            "%s %s",
-            "This FMU only supports scalar variables.",
-            "The number of value references and values must match!"
-        );
-        return fmi3Error;
-    }
+fmi3Status 
+Pipeline_configurable::enterEventMode()
+{
+    this->setMode( eventMode );
+    
+    // This is a time event that was previously signaled by function doStep, i.e., the
+    // earliest message is due at the current synchronization point and is available to
+    // be received by the importer.
+    if ( ( false == this->eventQueue_.empty() ) && ( this->eventQueue_.top().timeStamp <= this->syncTime_ ) )
+    {
+        const Event& evt = this->eventQueue_.top();
+        this->trace_.recordEgress( this->syncTime_, evt.msgId, evt.channel );
 
-    fmi3Status status = fmi3OK;
-    const fmi3ValueReference* vr;
-    const fmi3Int32* v;
-
-    for (
-        vr = valueReferences, v = values;
-        vr != valueReferences + nValues, v != values + nValues;
-        ++vr, ++v
-    ) {
-        switch ( *vr ) {
-            case this->vrIn_:
-                this->in_ = *v;
-                break;
-            case this->vrRandomSeed_:
-                this->randomSeed_ = *v;
-                break;
-            default:
-                this->logError( "Invalid value reference: %d", *vr );
-                status = fmi3Error;
-        }
+        const OutputChannel& output = this->outputChannels_[ evt.channel ];
+        *output.receiver = evt.msgId;
+        *output.clock = fmi3ClockActive;
 
-        this->logDebug( "Value reference %d => set to: %d (fmi3Int32)", *vr, *v );
+        // The event has been delivered, remove it from the queue.
+        this->eventQueue_.pop();
+        this->recordDelivered();
     }
 
-    return status;
+    return fmi3OK;
 }
 
 fmi3Status
-Pipeline_configurable::setFloat64(
-    const fmi3ValueReference valueReferences[],
-    size_t nValueReferences,
-    const fmi3Float64 values[],
-    size_t nValues
-) {
-    if ( nValueReferences != nValues ) {
-        this->logError(
-            "%s %s",
-            "This FMU only supports scalar variables.",
-            "The number of value references and values must match!"
-        );
-        return fmi3Error;
-    }
-
-    fmi3Status status = fmi3OK;
-    const fmi3ValueReference* vr;
-    const fmi3Float64* v;
-
-    for (
-        vr = valueReferences, v = values;
-        vr != valueReferences + nValues, v != values + nValues;
-        ++vr, ++v
-    ) {
-        switch ( *vr ) {
-            case this->vrRandomMean_:
-                this->randomMean_ = *v;
-                break;
-            case this->vrRandomStdDev_:
-                this->randomStdDev_ = *v;
-                break;
-            case this->vrRandomMin_:
-                this->randomMin_ = *v;
-                break;
-            default:
-                this->logError( "Invalid value reference: %d", *vr );
-                status = fmi3Error;
-        }
+Pipeline_configurable::terminate()
+{
+    this->logDebug(
+        logQueue, "event queue high-water mark: %zu events", this->eventQueue_.highWaterMark()
+    );
 
-        this->logDebug( 
-            "Value reference %d => set to: %f (fmi3Float64)", *vr, *v 
-        );
-    }
+    this->trace_.close();
 
-    return status;
+    return InstanceBase::terminate();
 }
 
 fmi3Status
-Pipeline_configurable::setClock(
-    const fmi3ValueReference valueReferences[],
-    size_t nValueReferences,
-    const fmi3Clock values[],
-    size_t nValues
-) {
-    if ( nValueReferences != nValues ) {
-        this->logError(
-            "%s %s",
-            "This FMU only supports scalar variables.",
-            "The number of value references and values must match!"
-        );
-        return fmi3Error;
-    }
-
-    fmi3Status status = fmi3OK;
-    const fmi3ValueReference* vr;
-    const fmi3Clock* v;
-
-    for (
-        vr = valueReferences, v = values;
-        vr != valueReferences + nValues, v != values + nValues;
-        ++vr, ++v
-    ) {
-        switch ( *vr ) {
-            case this->vrInClock_:
-                if ( fmi3ClockInactive == *v )
-                {
-                    this->logError(
-                        "clocks may not be deactivated by the importer"
-                    );
-                    return fmi3Error;
-                }
-                this->inClock_ = *v;
-                break;
-            default:
-                this->logError( "Invalid value reference: %d", *vr );
-                status = fmi3Error;
-        }
+Pipeline_configurable::reset()
+{
+    this->logDebug(
+        logQueue, "event queue high-water mark: %zu events", this->eventQueue_.highWaterMark()
+    );
 
-        this->logDebug( 
-            "%d => set clock %d", *vr, *v
-        );
-    }
+    this->eventQueue_.release();
+    this->nextEventTime_ = TickTime::never;
+    this->trace_.close();
+    this->resetStatistics();
 
-    return status;
+    return fmi3OK;
 }
 
 fmi3Status
@@ -390,72 +527,82 @@ Pipeline_configurable::updateDiscreteStates(
     fmi3Boolean *nextEventTimeDefined,
     fmi3Float64 *nextEventTime
 ) {
-    // Input clock is active --> add message as output using the calculated delay.
-    if ( fmi3ClockActive == this->inClock_ ) {
-
-        fmi3Float64 delay;
-        
-        // The event queue can only contain one event per timestamp. Since there is
-        // a (very small) chance that we generate a new random event with an already
-        // existing timestamp, insertion of new event is repeated until a new event
-        // has been inserted successfully.
-        do
+    // Input clock is active --> send the message to all output nodes reachable from the
+    // input node, with a delay sampled for each route plus the queueing delays at the
+    // links. The message crosses the pipes of the input's tree (parents first) until a
+    // pipe loses it, the outputs behind that pipe do not receive it. Messages that become
+    // due at the same time are delivered in the order of their arrival.
+    const size_t outputCount = this->outputs_.size();
+
+    for ( size_t i = 0; i < this->inputs_.size(); ++i )
+    {
+        if ( fmi3ClockActive != this->inputs_[i].clock ) continue;
+
+        const Crossing* tree = this->crossings_.data() + this->firstCrossing_[i];
+        const size_t treeSize = this->firstCrossing_[i + 1] - this->firstCrossing_[i];
+
+        for ( size_t c = 0; c < treeSize; ++c )
+        {
+            const bool root = ( noParent == tree[c].parent );
+            TimeStamp queueing = root ? 0 : this->queueing_[ tree[c].parent ];
+
+            this->crossed_[c] = ( root || this->crossed_[ tree[c].parent ] ) && this->crossPipe( tree[c], queueing );
+            this->queueing_[c] = queueing;
+        }
+
+        for ( size_t d = this->firstDestination_[i]; d < this->firstDestination_[i + 1]; ++d )
         {
-            delay = this->calculateDelay();
-        } 
-        while( false == this->addNewEvent(
-            this->syncTime_ + delay,
-            this->in_,
-            &this->out_,
-            &this->outClock_
-        ) );
+            const Channel channel = this->destinations_[d];
+            const Route& route = this->routes_[ i * outputCount + channel ];
+
+            // Lost on the way, never enters the event queue.
+            if ( 0 == this->crossed_[ this->destinationCrossing_[d] ] )
+            {
+                this->recordDropped();
+                continue;
+            }
+
+            TimeStamp delay = this->calculateDelay( route ) + this->queueing_[ this->destinationCrossing_[d] ];
+            this->trace_.recordIngress( this->syncTime_, delay, this->inputs_[i].value, channel );
+
+            this->addNewEvent(
+                this->syncTime_ + delay,
+                this->inputs_[i].value,
+                channel
+            );
+
+            this->recordSent( delay );
+        }
     }
 
     // Event queue is empty, next event time is undefined.
     if ( this->eventQueue_.empty() )
     {
-        this->nextEventTime_ = std::numeric_limits<fmi3Float64>::max();
+        this->nextEventTime_ = TickTime::never;
         *nextEventTimeDefined = fmi3False;
+        *nextEventTime = std::numeric_limits<fmi3Float64>::max();
+
+        this->logDebug(
+            logClock, "no next event defined"
+        );
     }
-    // We have not yet reached the next event, return the next event's time.
-    else if ( this->syncTime_ < this->nextEventTime_ - this->tolerance_ )
+    // Delivered events have already been removed, the earliest remaining event is next.
+    else
     {
-        this->nextEventTime_ = ( *this->currentEvent_ )->timeStamp;
+        this->nextEventTime_ = this->eventQueue_.top().timeStamp;
         *nextEventTimeDefined = fmi3True;
-    }
-    // We are processing the current event, increment event if possible.
-    else if ( fabs( this->syncTime_ - this->nextEventTime_ ) <= this->tolerance_ )
-    {
-        // There is a next event in the schedule --> increment current event and set
-        // time of this event as next event time.
-        if ( this->currentEvent_ != std::prev( this->eventQueue_.end() ) )
-        {
-            ++( this->currentEvent_ );
-
-            this->nextEventTime_ = ( *this->currentEvent_ )->timeStamp;
-            *nextEventTimeDefined = fmi3True;
+        *nextEventTime = this->toSeconds( this->nextEventTime_ );
 
-            this->logDebug(
-                "set next event time to t = %f",
-                this->nextEventTime_
-            );
-        }
-        else // There is NO next event in the schedule, next event time is undefined.
-        {
-            this->nextEventTime_ = std::numeric_limits<fmi3Float64>::max();
-            *nextEventTimeDefined = fmi3False;
-
-            this->logDebug(
-                "no next event defined"
-            );
-        }
+        this->logDebug(
+            logClock, "set next event time to t = %f",
+            *nextEventTime
+        );
     }
 
     *discreteStatesNeedUpdate = fmi3False;
     *terminateSimulation = fmi3False;
     *nominalsOfContinuousStatesChanged = fmi3False;
     *valuesOfContinuousStatesChanged = fmi3False;
-    *nextEventTime = this->nextEventTime_;
 
     // We have finished processing internal events --> deactivate all active clocks.
     this->deactivateAllClocks();
@@ -475,46 +622,48 @@ Pipeline_configurable::doStep(
 ) {
     // Sanity check: Do the importer's current communication point and the internal
     // synchronization time coincide?
-    if ( fabs( this->syncTime_ - currentCommunicationPoint ) > this->tolerance_ )
+    TickTime::Ticks currentTime = this->toTicks( currentCommunicationPoint );
+    if ( std::llabs( this->syncTime_ - currentTime ) > this->toleranceTicks_ )
     {
         this->logError(
             "Current communication point (%f) does not coincide with the internal time (%f)",
-            currentCommunicationPoint, this->syncTime_
+            currentCommunicationPoint, this->toSeconds( this->syncTime_ )
         );
 
         return fmi3Discard;
     }
 
-    // Update internal synchronization time to new requested communication point.
-    this->syncTime_ = currentCommunicationPoint + communicationStepSize;
+    // New requested communication point.
+    TickTime::Ticks targetTime = this->toTicks( currentCommunicationPoint + communicationStepSize );
     this->logDebug(
-        "Attempt to step from %f to %f",
+        logStep, "Attempt to step from %f to %f",
         currentCommunicationPoint,
-        this->syncTime_
+        currentCommunicationPoint + communicationStepSize
     );
 
-    // The importer stepped over an event.
-    if ( this->syncTime_ > this->nextEventTime_ )
+    // The importer stepped over an event --> return early at the event time.
+    if ( targetTime > this->nextEventTime_ )
     {
+        this->syncTime_ = this->nextEventTime_;
         this->logDebug(
-            "%s %s %f",
+            logStep, "%s %s %f",
             "The importer stepped over an event.",
             "The current internal time (lastSuccessfulTime) is: ",
-            this->nextEventTime_
+            this->toSeconds( this->syncTime_ )
         );
 
         *eventEncountered = fmi3True;
         *earlyReturn = fmi3True;
-        *lastSuccessfulTime = this->nextEventTime_;
+        *lastSuccessfulTime = this->toSeconds( this->syncTime_ );
     }
-    // The importer has reached the next event.
-    else if ( fabs( this->syncTime_ - this->nextEventTime_ ) <= this->tolerance_ )
+    // The importer has reached the next event (within tolerance).
+    else if ( targetTime >= this->nextEventTime_ - this->toleranceTicks_ )
     {
         this->logDebug(
-            "The importer has reached the next event at the new synchronization point."
+            logStep, "The importer has reached the next event at the new synchronization point."
         );
 
-        if ( this->currentEvent_ == this->eventQueue_.end() )
+        if ( this->eventQueue_.empty() )
         {
             this->logError(
                 "corrupted event queue"
@@ -524,19 +673,22 @@ Pipeline_configurable::doStep(
             return fmi3Fatal;
         }
 
+        this->syncTime_ = this->nextEventTime_;
+
         *eventEncountered = fmi3True;
         *earlyReturn = fmi3False;
-        *lastSuccessfulTime = this->syncTime_;
+        *lastSuccessfulTime = this->toSeconds( this->syncTime_ );
     }
     else // The importer has not yet reached the next event.
     {
+        this->syncTime_ = targetTime;
         this->logDebug(
-            "The importer has not yet reached the next event."
+            logStep, "The importer has not yet reached the next event."
         );
 
         *eventEncountered = fmi3False;
         *earlyReturn = fmi3False;
-        *lastSuccessfulTime = this->syncTime_;
+        *lastSuccessfulTime = this->toSeconds( this->syncTime_ );
     }
 
     *terminateSimulation = fmi3False;
@@ -544,65 +696,426 @@ Pipeline_configurable::doStep(
     return fmi3OK;
 }
 
+fmi3Status
+Pipeline_configurable::getFMUState(
+    fmi3FMUState* fmuState
+) {
+    // An existing state is overwritten.
+    State* state = static_cast<State*>( *fmuState );
+    if ( nullptr == state )
+    {
+        state = new State();
+    }
+
+    this->saveState( *state );
+    *fmuState = state;
+
+    return fmi3OK;
+}
+
+fmi3Status
+Pipeline_configurable::setFMUState(
+    fmi3FMUState fmuState
+) {
+    if ( nullptr == fmuState )
+    {
+        this->logError( "Invalid FMU state" );
+        return fmi3Error;
+    }
+
+    this->restoreState( *static_cast<const State*>( fmuState ) );
+
+    return fmi3OK;
+}
+
+fmi3Status
+Pipeline_configurable::freeFMUState(
+    fmi3FMUState* fmuState
+) {
+    delete static_cast<State*>( *fmuState );
+    *fmuState = nullptr;
+
+    return fmi3OK;
+}
+
+fmi3Status
+Pipeline_configurable::serializedFMUStateSize(
+    fmi3FMUState fmuState,
+    size_t* size
+) {
+    if ( nullptr == fmuState )
+    {
+        this->logError( "Invalid FMU state" );
+        return fmi3Error;
+    }
+
+    StateSerialization::Writer counter( nullptr, 0 );
+    this->serializeState( *static_cast<const State*>( fmuState ), counter );
+    *size = counter.size();
+
+    return fmi3OK;
+}
+
+fmi3Status
+Pipeline_configurable::serializeFMUState(
+    fmi3FMUState fmuState,
+    fmi3Byte serializedState[],
+    size_t size
+) {
+    if ( nullptr == fmuState )
+    {
+        this->logError( "Invalid FMU state" );
+        return fmi3Error;
+    }
+
+    // The state is written directly into the importer's buffer.
+    StateSerialization::Writer writer( serializedState, size );
+    this->serializeState( *static_cast<const State*>( fmuState ), writer );
+
+    if ( false == writer.ok() )
+    {
+        this->logError( "Buffer too small for the serialized FMU state (%zu bytes required)", writer.size() );
+        return fmi3Error;
+    }
+
+    return fmi3OK;
+}
+
+fmi3Status
+Pipeline_configurable::deSerializeFMUState(
+    const fmi3Byte serializedState[],
+    size_t size,
+    fmi3FMUState* fmuState
+) {
+    // An existing state is overwritten.
+    State* state = static_cast<State*>( *fmuState );
+    if ( nullptr == state )
+    {
+        state = new State();
+    }
+
+    StateSerialization::Reader reader( serializedState, size );
+
+    if ( false == this->deserializeState( reader, *state ) )
+    {
+        if ( state != *fmuState ) delete state;
+
+        this->logError( "Invalid serialized FMU state" );
+        return fmi3Error;
+    }
+
+    *fmuState = state;
+
+    return fmi3OK;
+}
+
+void
+Pipeline_configurable::saveState( State& state ) const
+{
+    state.mode = this->getMode();
+    state.inputs = this->inputs_;
+    state.outputs = this->outputs_;
+    state.pipeBad = this->pipeBad_;
+    state.linkBusyUntil = this->linkBusyUntil_;
+    state.messagesSent = this->messagesSent_;
+    state.messagesDelivered = this->messagesDelivered_;
+    state.messagesDropped = this->messagesDropped_;
+    state.meanDelay = this->meanDelay_;
+    state.maxDelay = this->maxDelay_;
+    state.lastDeliveryTime = this->lastDeliveryTime_;
+    state.syncTime = this->syncTime_;
+    state.nextEventTime = this->nextEventTime_;
+    state.eventQueue = this->eventQueue_;
+    state.generator = this->generator_;
+}
+
+void
+Pipeline_configurable::restoreState( const State& state )
+{
+    this->setMode( state.mode );
+    // Element-wise, the variable tables and output channels point into the vectors.
+    std::copy( state.inputs.begin(), state.inputs.end(), this->inputs_.begin() );
+    std::copy( state.outputs.begin(), state.outputs.end(), this->outputs_.begin() );
+    this->pipeBad_ = state.pipeBad;
+    this->linkBusyUntil_ = state.linkBusyUntil;
+    this->messagesSent_ = state.messagesSent;
+    this->messagesDelivered_ = state.messagesDelivered;
+    this->messagesDropped_ = state.messagesDropped;
+    this->meanDelay_ = state.meanDelay;
+    this->maxDelay_ = state.maxDelay;
+    this->lastDeliveryTime_ = state.lastDeliveryTime;
+    this->syncTime_ = state.syncTime;
+    this->nextEventTime_ = state.nextEventTime;
+    this->eventQueue_ = state.eventQueue;
+    this->generator_ = state.generator;
+
+    this->queueDepth_ = this->eventQueue_.size();
+    this->messagesInFlight_ = this->messagesSent_ - this->messagesDelivered_ - this->messagesDropped_;
+}
+
+void
+Pipeline_configurable::serializeState(
+    const State& state,
+    StateSerialization::Writer& writer
+) const {
+    writer.putHeader( INSTANTIATION_TOKEN );
+    writer.put<int32_t>( state.mode );
+
+    writer.put<uint32_t>( static_cast<uint32_t>( state.inputs.size() ) );
+    for ( const NodeVariables& input : state.inputs )
+    {
+        writer.put<int32_t>( input.value );
+        writer.put<uint8_t>( input.clock );
+    }
+
+    writer.put<uint32_t>( static_cast<uint32_t>( state.outputs.size() ) );
+    for ( const NodeVariables& output : state.outputs )
+    {
+        writer.put<int32_t>( output.value );
+        writer.put<uint8_t>( output.clock );
+    }
+
+    // States of the loss models of the pipes.
+    writer.put<uint32_t>( static_cast<uint32_t>( state.pipeBad.size() ) );
+    for ( uint8_t bad : state.pipeBad ) writer.put<uint8_t>( bad );
+
+    // States of the link models of the pipes.
+    writer.put<uint32_t>( static_cast<uint32_t>( state.linkBusyUntil.size() ) );
+    for ( TickTime::Ticks busyUntil : state.linkBusyUntil ) writer.put<int64_t>( busyUntil );
+
+    writer.put<uint64_t>( state.messagesSent );
+    writer.put<uint64_t>( state.messagesDelivered );
+    writer.put<uint64_t>( state.messagesDropped );
+    writer.put<double>( state.meanDelay );
+    writer.put<double>( state.maxDelay );
+    writer.put<double>( state.lastDeliveryTime );
+
+    writer.put<int64_t>( state.syncTime );
+    writer.put<int64_t>( state.nextEventTime );
+
+    writer.putGenerator( state.generator );
+
+    // Event queue, 14 bytes per event (plus the arrival number for the heap).
+    const EventQueue::Backend backend = state.eventQueue.getBackend();
+    writer.put<int32_t>( backend );
+    writer.put<uint64_t>( state.eventQueue.sequence() );
+    writer.put<uint64_t>( state.eventQueue.size() );
+
+    state.eventQueue.visit(
+        [&writer, backend]( const Event& evt, uint64_t arrival )
+        {
+            writer.put<int64_t>( evt.timeStamp );
+            writer.put<int32_t>( evt.msgId );
+            writer.put<uint16_t>( evt.channel );
+            if ( EventQueue::heap == backend ) writer.put<uint64_t>( arrival );
+        }
+    );
+}
+
 bool
+Pipeline_configurable::deserializeState(
+    StateSerialization::Reader& reader,
+    State& state
+) const {
+    if ( false == reader.getHeader( INSTANTIATION_TOKEN ) ) return false;
+
+    int32_t mode = reader.get<int32_t>();
+    if ( ( 0 >= mode ) || ( fatal < mode ) || ( 0 != ( mode & ( mode - 1 ) ) ) ) return false;
+
+    state.mode = static_cast<FMUMode>( mode );
+
+    // The number of input and output nodes must match the network of this instance.
+    if ( this->inputs_.size() != reader.get<uint32_t>() ) return false;
+    state.inputs.resize( this->inputs_.size() );
+    for ( NodeVariables& input : state.inputs )
+    {
+        input.value = reader.get<int32_t>();
+        input.clock = ( 0 != reader.get<uint8_t>() );
+    }
+
+    if ( this->outputs_.size() != reader.get<uint32_t>() ) return false;
+    state.outputs.resize( this->outputs_.size() );
+    for ( NodeVariables& output : state.outputs )
+    {
+        output.value = reader.get<int32_t>();
+        output.clock = ( 0 != reader.get<uint8_t>() );
+    }
+
+    if ( this->pipeBad_.size() != reader.get<uint32_t>() ) return false;
+    state.pipeBad.resize( this->pipeBad_.size() );
+    for ( uint8_t& bad : state.pipeBad ) bad = ( 0 != reader.get<uint8_t>() ) ? 1 : 0;
+
+    if ( this->linkBusyUntil_.size() != reader.get<uint32_t>() ) return false;
+    state.linkBusyUntil.resize( this->linkBusyUntil_.size() );
+    for ( TickTime::Ticks& busyUntil : state.linkBusyUntil ) busyUntil = reader.get<int64_t>();
+
+    state.messagesSent = reader.get<uint64_t>();
+    state.messagesDelivered = reader.get<uint64_t>();
+    state.messagesDropped = reader.get<uint64_t>();
+    state.meanDelay = reader.get<double>();
+    state.maxDelay = reader.get<double>();
+    state.lastDeliveryTime = reader.get<double>();
+
+    state.syncTime = reader.get<int64_t>();
+    state.nextEventTime = reader.get<int64_t>();
+
+    reader.getGenerator( state.generator );
+
+    // Event queue, restored record by record in the serialized order.
+    const int32_t backend = reader.get<int32_t>();
+    const uint64_t sequence = reader.get<uint64_t>();
+    const uint64_t count = reader.get<uint64_t>();
+
+    if ( ( false == reader.ok() ) || ( false == EventQueue::isValidBackend( backend ) ) ) return false;
+
+    state.eventQueue.restore( static_cast<EventQueue::Backend>( backend ), sequence );
+
+    for ( uint64_t i = 0; i < count; ++i )
+    {
+        TimeStamp timeStamp = reader.get<int64_t>();
+        MessageID msgId = reader.get<int32_t>();
+        Channel channel = reader.get<uint16_t>();
+        uint64_t arrival = ( EventQueue::heap == backend ) ? reader.get<uint64_t>() : 0;
+
+        if ( ( false == reader.ok() ) || ( channel >= this->outputChannels_.size() ) ) return false;
+
+        if ( false == state.eventQueue.restoreEvent( Event( timeStamp, msgId, channel ), arrival ) ) return false;
+    }
+
+    return reader.ok() && reader.atEnd();
+}
+
+void
 Pipeline_configurable::addNewEvent(
     const TimeStamp& msgReceiveTime,
     const MessageID& msgId,
-    const Receiver& receiver,
-    const ReceiverClock& clock
+    const Channel& channel
 ) {
-    bool firstEvent = this->eventQueue_.empty();
-
-    // Create new event.
-    Event* evt = new Event(
-        msgReceiveTime,
-        msgId,
-        receiver,
-        clock
-    );
-
     this->logDebug(
-        "add new event at t = %f - id = %d", msgReceiveTime, msgId
+        logQueue, "add new event at t = %f - id = %d", this->toSeconds( msgReceiveTime ), msgId
     );
 
-    // Insert event into queue.
-    std::pair<EventQueue::iterator ,bool> insertResult = this->eventQueue_.insert( evt );
-    bool validEvent = insertResult.second;
+    // Insert event into queue (stored by value, no allocation in steady state).
+    this->eventQueue_.push( Event( msgReceiveTime, msgId, channel ) );
 
-    // Delete the event, because it has not been inserted successfully (another event with
-    // the same timestamp alreay exists).
-    if ( false == validEvent )
+    if ( msgReceiveTime < this->nextEventTime_ )
     {
-        this->logDebug(
-            "veto for event at t = %f", msgReceiveTime
-        );
+        this->nextEventTime_ = msgReceiveTime;
+    }
+}
+
+bool
+Pipeline_configurable::crossPipe( const Crossing& crossing, TimeStamp& queueing )
+{
+    const uint32_t pipe = crossing.pipe;
 
-        delete evt;
-        return false;
+    // Link with a limited bandwidth: the message arrives after the mean delays and the
+    // queueing delays of the preceding pipes. It waits for the messages queued before it
+    // (backlog) and is dropped if it does not fit into the buffer.
+    const PipeLink& link = this->pipeLinks_[pipe];
+    if ( 0. < link.bandwidth )
+    {
+        TickTime::Ticks& busyUntil = this->linkBusyUntil_[pipe];
+        const TickTime::Ticks arrival = this->syncTime_ + this->toTicks( crossing.offset ) + queueing;
+        const TickTime::Ticks backlog = std::max<TickTime::Ticks>( busyUntil - arrival, 0 );
+
+        if ( backlog > link.maxBacklog - link.transmission ) return false;
+
+        busyUntil = arrival + backlog + link.transmission;
+        queueing += backlog + link.transmission;
     }
 
-    if ( firstEvent || ( msgReceiveTime < this->nextEventTime_ ) )
+    const PipeLoss& model = this->pipeLoss_[pipe];
+    uint8_t& bad = this->pipeBad_[pipe];
+
+    // State transition (pipes without bursts stay in the good state, no random numbers).
+    if ( 0 != bad )
     {
-        this->currentEvent_ = insertResult.first;
-        this->nextEventTime_ = msgReceiveTime;
+        if ( this->generator_.uniform() < model.badToGood ) bad = 0;
+    }
+    else if ( ( 0. < model.goodToBad ) && ( this->generator_.uniform() < model.goodToBad ) )
+    {
+        bad = 1;
     }
 
-    return true;
+    const fmi3Float64 loss = ( 0 != bad ) ? model.lossBad : model.lossGood;
+
+    return ( false == ( ( 0. < loss ) && ( this->generator_.uniform() < loss ) ) );
+}
+
+TimeStamp
+Pipeline_configurable::calculateDelay( const Route& route )
+{
+    // Empirical distribution (non-negative by construction, the same for all routes) or
+    // normal distribution of the route (no negative delays!).
+    if ( false == this->delayTable_.empty() )
+    {
+        return this->toTicks( this->delayTable_( this->generator_ ) );
+    }
+
+    return this->toTicks( std::max( route.delay + route.jitter * this->generator_(), 0. ) );
+}
+
+TickTime::Ticks
+Pipeline_configurable::toTicks( fmi3Float64 t ) const
+{
+    return TickTime::fromSeconds( t, this->ticksPerSecond_ );
 }
 
 fmi3Float64
-Pipeline_configurable::calculateDelay()
+Pipeline_configurable::toSeconds( TickTime::Ticks t ) const
 {
-    // No negative delays!
-    return std::max(
-        this->distribution_( this->generator_ ),
-        this->randomMin_
-    );
+    return TickTime::toSeconds( t, this->ticksPerSecond_ );
 }
 
 void
 Pipeline_configurable::deactivateAllClocks()
 {
-    inClock_ = fmi3ClockInactive;
-    outClock_ = fmi3ClockInactive;
+    for ( NodeVariables& input : this->inputs_ ) input.clock = fmi3ClockInactive;
+    for ( NodeVariables& output : this->outputs_ ) output.clock = fmi3ClockInactive;
+}
+
+void
+Pipeline_configurable::recordSent( TimeStamp delay )
+{
+    const fmi3Float64 seconds = this->toSeconds( delay );
+
+    ++this->messagesSent_;
+    this->meanDelay_ += ( seconds - this->meanDelay_ ) / ( this->messagesSent_ - this->messagesDropped_ );
+    this->maxDelay_ = std::max( this->maxDelay_, seconds );
+
+    this->queueDepth_ = this->eventQueue_.size();
+    this->messagesInFlight_ = this->messagesSent_ - this->messagesDelivered_ - this->messagesDropped_;
+}
+
+void
+Pipeline_configurable::recordDelivered()
+{
+    ++this->messagesDelivered_;
+    this->lastDeliveryTime_ = this->toSeconds( this->syncTime_ );
+
+    this->queueDepth_ = this->eventQueue_.size();
+    this->messagesInFlight_ = this->messagesSent_ - this->messagesDelivered_ - this->messagesDropped_;
+}
+
+void
+Pipeline_configurable::recordDropped()
+{
+    ++this->messagesSent_;
+    ++this->messagesDropped_;
+
+    this->messagesInFlight_ = this->messagesSent_ - this->messagesDelivered_ - this->messagesDropped_;
+}
+
+void
+Pipeline_configurable::resetStatistics()
+{
+    this->queueDepth_ = 0;
+    this->messagesInFlight_ = 0;
+    this->messagesSent_ = 0;
+    this->messagesDelivered_ = 0;
+    this->messagesDropped_ = 0;
+    this->meanDelay_ = 0.;
+    this->maxDelay_ = 0.;
+    this->lastDeliveryTime_ = 0.;
 }
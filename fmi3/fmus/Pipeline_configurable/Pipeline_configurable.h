@@ -7,10 +7,16 @@
 #ifndef Pipeline_configurable_h
 #define Pipeline_configurable_h
 
-#include <random>
+#include <cstdint>
+#include <string>
+#include <vector>
 
 #include "InstanceBase.h"
 #include "ConfigurableEventQueue.h"
+#include "EmpiricalDistribution.h"
+#include "EventTrace.h"
+#include "NormalGenerator.h"
+#include "StateSerialization.h"
 
 class Pipeline_configurable : public InstanceBase {
 
@@ -27,8 +33,8 @@ public:
         const fmi3ValueReference requiredIntermediateVariables[],
         size_t nRequiredIntermediateVariables,
         fmi3InstanceEnvironment instanceEnvironment,
-        fmi3CallbackLogMessage logMessage,
-        fmi3CallbackIntermediateUpdate intermediateUpdate
+        fmi3LogMessageCallback logMessage,
+        fmi3IntermediateUpdateCallback intermediateUpdate
     );
 
     virtual fmi3Status enterInitializationMode(
@@ -41,58 +47,48 @@ public:
 
     virtual fmi3Status exitInitializationMode();
 
-    virtual fmi3Status enterEventMode(
-        fmi3Boolean stepEvent,
-        fmi3Boolean stateEvent,
-        const fmi3Int32 rootsFound[],
-        size_t nEventIndicators,
-        fmi3Boolean timeEvent
-    );
+    virtual fmi3Status enterEventMode();
+
+    virtual fmi3Status terminate();
 
     virtual fmi3Status reset();
 
-    virtual fmi3Status getInt32(
-        const fmi3ValueReference valueReferences[],
-        size_t nValueReferences,
-        fmi3Int32 values[],
-        size_t nValues
+    virtual fmi3Status updateDiscreteStates(
+        fmi3Boolean *discreteStatesNeedUpdate,
+        fmi3Boolean *terminateSimulation,
+        fmi3Boolean *nominalsOfContinuousStatesChanged,
+        fmi3Boolean *valuesOfContinuousStatesChanged,
+        fmi3Boolean *nextEventTimeDefined,
+        fmi3Float64 *nextEventTime
     );
 
-    virtual fmi3Status getClock(
-        const fmi3ValueReference valueReferences[],
-        size_t nValueReferences,
-        fmi3Clock values[],
-        size_t nValues
+    virtual fmi3Status getFMUState(
+        fmi3FMUState* fmuState
     );
 
-    virtual fmi3Status setFloat64(
-        const fmi3ValueReference valueReferences[],
-        size_t nValueReferences,
-        const fmi3Float64 values[],
-        size_t nValues
+    virtual fmi3Status setFMUState(
+        fmi3FMUState fmuState
     );
 
-    virtual fmi3Status setInt32(
-        const fmi3ValueReference valueReferences[],
-        size_t nValueReferences,
-        const fmi3Int32 values[],
-        size_t nValues
+    virtual fmi3Status freeFMUState(
+        fmi3FMUState* fmuState
     );
 
-    virtual fmi3Status setClock(
-        const fmi3ValueReference valueReferences[],
-        size_t nValueReferences,
-        const fmi3Clock values[],
-        size_t nValues
+    virtual fmi3Status serializedFMUStateSize(
+        fmi3FMUState fmuState,
+        size_t* size
     );
 
-    virtual fmi3Status updateDiscreteStates(
-        fmi3Boolean *discreteStatesNeedUpdate,
-        fmi3Boolean *terminateSimulation,
-        fmi3Boolean *nominalsOfContinuousStatesChanged,
-        fmi3Boolean *valuesOfContinuousStatesChanged,
-        fmi3Boolean *nextEventTimeDefined,
-        fmi3Float64 *nextEventTime
+    virtual fmi3Status serializeFMUState(
+        fmi3FMUState fmuState,
+        fmi3Byte serializedState[],
+        size_t size
+    );
+
+    virtual fmi3Status deSerializeFMUState(
+        const fmi3Byte serializedState[],
+        size_t size,
+        fmi3FMUState* fmuState
     );
 
     virtual fmi3Status doStep(
@@ -107,69 +103,253 @@ public:
 
 private:
 
-    bool parseNetworkConfig(fmi3String filename);
-    
+    // Value and clock of an input or output node of the network.
+    struct NodeVariables {
+        fmi3Int32 value;
+        fmi3Clock clock;
+    };
+
+    // Delay of the route from an input node to an output node, combined from the pipes
+    // along the route (see parseNetworkConfig).
+    struct Route {
+        bool reachable;
+        fmi3Float64 delay;  // sum of the mean delays of the pipes (seconds)
+        fmi3Float64 jitter; // standard deviation of the sum of the pipe delays (seconds)
+    };
+
+    // Gilbert-Elliott loss model of a pipe (see NetworkPipeline).
+    struct PipeLoss {
+        fmi3Float64 goodToBad;
+        fmi3Float64 badToGood;
+        fmi3Float64 lossGood;
+        fmi3Float64 lossBad;
+    };
+
+    // Link model of a pipe (see NetworkPipeline), transmission times in ticks are
+    // computed in exitInitializationMode.
+    struct PipeLink {
+        fmi3Float64 bandwidth; // bytes per second (0: unlimited, no queue)
+        fmi3Float64 buffer;    // bytes
+        TickTime::Ticks transmission; // transmission time of a message
+        TickTime::Ticks maxBacklog;   // transmission time of a full buffer
+    };
+
+    // A pipe in the tree of the routes of an input node.
+    struct Crossing {
+        uint32_t pipe;
+        uint32_t parent;    // crossing of the preceding pipe in the tree (noParent: none)
+        fmi3Float64 offset; // mean delay from the input node to the pipe (seconds)
+    };
+
+    static const uint32_t noParent = 0xffffffff;
+
+    // Snapshot of the state of the pipeline (see getFMUState). The event queue shares its
+    // storage with the pipeline's queue (copy-on-write), i.e., taking and restoring a
+    // snapshot does not depend on the number of events in flight.
+    struct State {
+        FMUMode mode;
+        std::vector<NodeVariables> inputs;
+        std::vector<NodeVariables> outputs;
+        std::vector<uint8_t> pipeBad;
+        std::vector<TickTime::Ticks> linkBusyUntil;
+        fmi3UInt64 messagesSent;
+        fmi3UInt64 messagesDelivered;
+        fmi3UInt64 messagesDropped;
+        fmi3Float64 meanDelay;
+        fmi3Float64 maxDelay;
+        fmi3Float64 lastDeliveryTime;
+        TickTime::Ticks syncTime;
+        TickTime::Ticks nextEventTime;
+        ConfigurableEventQueue::EventQueue eventQueue;
+        NormalGenerator generator;
+    };
+
+    void saveState( State& state ) const;
+    void restoreState( const State& state );
+
+    // Write a state in the binary format of serialized states (see StateSerialization.h).
+    void serializeState( const State& state, StateSerialization::Writer& writer ) const;
+
+    // Read a serialized state, returns false if the data is invalid for this instance.
+    bool deserializeState( StateSerialization::Reader& reader, State& state ) const;
+
+    // Read the network configuration, create the variables of the input and output nodes
+    // and compute the routes between them (throws std::runtime_error if the configuration
+    // is invalid).
+    void parseNetworkConfig( const std::string& fileName );
+
 	// This function adds new events to the event queue.
-	bool addNewEvent( 
+	void addNewEvent( 
         const ConfigurableEventQueue::TimeStamp& msgReceiveTime,
         const ConfigurableEventQueue::MessageID& msgId,
-        const ConfigurableEventQueue::Receiver& receiver,
-        const ConfigurableEventQueue::ReceiverClock& clock
+        const ConfigurableEventQueue::Channel& channel
     );
 
-    fmi3Float64 calculateDelay();
-
-    void deactivateAllClocks();
+    // Advance the link and loss models of a pipe for a message that crosses it. The
+    // queueing delay (ticks) of the message is increased by the waiting and transmission
+    // time at the link. Returns false if the link's buffer is full or the pipe loses the
+    // message.
+    bool crossPipe( const Crossing& crossing, ConfigurableEventQueue::TimeStamp& queueing );
 
-    // Input variable "in" (value reference 1001).
-    fmi3Int32 in_;
-    static const fmi3ValueReference vrIn_ = 1001;
+    ConfigurableEventQueue::TimeStamp calculateDelay( const Route& route );
 
-    // Input clock "in_clock" (value reference 1002).
-    fmi3Clock inClock_;
-    static const fmi3ValueReference vrInClock_ = 1002;
+    // Conversion between FMI time (seconds) and internal time (ticks).
+    TickTime::Ticks toTicks( fmi3Float64 t ) const;
+    fmi3Float64 toSeconds( TickTime::Ticks t ) const;
 
-    // Output variable "out" (value reference 2001).
-    fmi3Int32 out_;
-    static const fmi3ValueReference vrOut_ = 2001;
+    void deactivateAllClocks();
 
-    // Output clock "out_clock" (value reference 2002).
-    fmi3Clock outClock_;
-    static const fmi3ValueReference vrOutClock_ = 2002;
+    // Update the statistics when a message has been sent, delivered or dropped (constant
+    // time). Dropped messages count as sent, without a delay.
+    void recordSent( ConfigurableEventQueue::TimeStamp delay );
+    void recordDelivered();
+    void recordDropped();
+    void resetStatistics();
+
+    // Input nodes of the network (only outgoing pipes), in the order of network.json. The
+    // variable of input i has the value reference 1001 + 2i, its clock 1002 + 2i.
+    std::vector<NodeVariables> inputs_;
+    static const fmi3ValueReference vrFirstInput_ = 1001;
+
+    // Output nodes of the network (only incoming pipes), in the order of network.json. The
+    // variable of output j has the value reference 2001 + 2j, its clock 2002 + 2j.
+    std::vector<NodeVariables> outputs_;
+    static const fmi3ValueReference vrFirstOutput_ = 2001;
+
+    // Maximum number of input or output nodes (value references below 2001 and 3001).
+    static const size_t maxNodes_ = 500;
+
+    // Clock "__DUMMY" (value reference 999), declared in FMI3.xml for networks with
+    // intermediate nodes. Messages pass intermediate nodes internally, it never ticks.
+    fmi3Clock dummyClock_;
+    static const fmi3ValueReference vrDummyClock_ = 999;
+
+    // Output channels, indexed by the channel of an event (channel j: output node j).
+    std::vector<ConfigurableEventQueue::OutputChannel> outputChannels_;
+
+    // Routes from the input to the output nodes, a flat table indexed by
+    // input * number of outputs + output (computed once at instantiation).
+    std::vector<Route> routes_;
+
+    // Reachable outputs of the input nodes: destinations_[firstDestination_[i]] up to
+    // destinations_[firstDestination_[i + 1] - 1] for input i.
+    std::vector<ConfigurableEventQueue::Channel> destinations_;
+    std::vector<size_t> firstDestination_;
+
+    // Crossing of the last pipe of the route to each destination (within the tree of the
+    // input node, same order as destinations_).
+    std::vector<uint32_t> destinationCrossing_;
+
+    // Trees of the routes of the input nodes: crossings_[firstCrossing_[i]] up to
+    // crossings_[firstCrossing_[i + 1] - 1] for input i, parents before their children.
+    std::vector<Crossing> crossings_;
+    std::vector<size_t> firstCrossing_;
+
+    // Pipes of the current tree crossed by the current message (1) or not (0) and the
+    // queueing delay of the message up to the end of each pipe (ticks).
+    std::vector<uint8_t> crossed_;
+    std::vector<ConfigurableEventQueue::TimeStamp> queueing_;
+
+    // Loss models of the pipes and their states (1: bad state), in the order of the
+    // pipes' names.
+    std::vector<PipeLoss> pipeLoss_;
+    std::vector<uint8_t> pipeBad_;
+
+    // Link models of the pipes and their states: time at which a link has transmitted all
+    // queued messages (ticks). Messages are queued in the order in which they are sent.
+    std::vector<PipeLink> pipeLinks_;
+    std::vector<TickTime::Ticks> linkBusyUntil_;
 
 	// Random number generator seed (parameter, value reference 3001).
 	fmi3Int32 randomSeed_;
     static const fmi3ValueReference vrRandomSeed_ = 3001;
 
-    // Random number distribution mean (parameter, value reference 3002).
-    fmi3Float64 randomMean_;
-    static const fmi3ValueReference vrRandomMean_ = 3002;
+    // Resolution of the internal time base in ticks per second (parameter, value reference 3005).
+    fmi3Int32 ticksPerSecond_;
+    static const fmi3ValueReference vrTicksPerSecond_ = 3005;
+
+    // Event queue backend, 0: heap, 1: timing wheel (parameter, value reference 3006).
+    fmi3Int32 eventScheduler_;
+    static const fmi3ValueReference vrEventScheduler_ = 3006;
+
+    // File of an empirical delay distribution in the resource directory, empty: normal
+    // distributions of the routes (parameter, value reference 3007, see
+    // EmpiricalDistribution.h).
+    std::string delayDistribution_;
+    static const fmi3ValueReference vrDelayDistribution_ = 3007;
+
+    // Size of the messages in bytes, determines their transmission time on pipes with a
+    // limited bandwidth (parameter, value reference 3008).
+    fmi3Int32 messageSize_;
+    static const fmi3ValueReference vrMessageSize_ = 3008;
 
-    // Random number distribution standard deviation (parameter, value reference 3003).
-    fmi3Float64 randomStdDev_;
-    static const fmi3ValueReference vrRandomStdDev_ = 3003;
+    // Number of records of the message trace, 0: no trace (parameter, value reference 3009).
+    fmi3UInt64 traceCapacity_;
+    static const fmi3ValueReference vrTraceCapacity_ = 3009;
 
-    // Random number distribution minimum value (parameter, value reference 3004).
-    fmi3Float64 randomMin_;
-    static const fmi3ValueReference vrRandomMin_ = 3004;
+    // Statistics of the pipeline (outputs, value references 4001 to 4008), updated with every
+    // message sent or delivered.
 
-    // Current internal synchronization point.
-    fmi3Float64 syncTime_;
+    // Number of events in the event queue (value reference 4001).
+    fmi3UInt64 queueDepth_;
+    static const fmi3ValueReference vrQueueDepth_ = 4001;
 
-	// Time of the next scheduled event.
-	fmi3Float64 nextEventTime_;
+    // Number of messages sent and neither delivered nor dropped yet (value reference 4002).
+    fmi3UInt64 messagesInFlight_;
+    static const fmi3ValueReference vrMessagesInFlight_ = 4002;
 
-	// Precision for detecting events.
+    // Total number of messages sent, delivered and dropped (value references 4003, 4004 and 4005).
+    fmi3UInt64 messagesSent_;
+    static const fmi3ValueReference vrMessagesSent_ = 4003;
+    fmi3UInt64 messagesDelivered_;
+    static const fmi3ValueReference vrMessagesDelivered_ = 4004;
+    fmi3UInt64 messagesDropped_;
+    static const fmi3ValueReference vrMessagesDropped_ = 4005;
+
+    // Mean and maximum of the sampled delays in seconds (value references 4006 and 4007).
+    fmi3Float64 meanDelay_;
+    static const fmi3ValueReference vrMeanDelay_ = 4006;
+    fmi3Float64 maxDelay_;
+    static const fmi3ValueReference vrMaxDelay_ = 4007;
+
+    // Time of the last delivery in seconds (value reference 4008).
+    fmi3Float64 lastDeliveryTime_;
+    static const fmi3ValueReference vrLastDeliveryTime_ = 4008;
+
+    // Simulation start time (seconds).
+    fmi3Float64 startTime_;
+
+    // Current internal synchronization point (ticks).
+    TickTime::Ticks syncTime_;
+
+	// Time of the next scheduled event (ticks).
+	TickTime::Ticks nextEventTime_;
+
+	// Precision for matching the importer's communication points (seconds and ticks).
 	fmi3Float64 tolerance_;
+	TickTime::Ticks toleranceTicks_;
 
 	// Event queue.
 	ConfigurableEventQueue::EventQueue eventQueue_;
-	ConfigurableEventQueue::EventQueue::iterator currentEvent_;
 
-    // Random generator (Gaussian);
-    std::default_random_engine generator_;
-    std::normal_distribution<fmi3Float64> distribution_;
+	// Trace of the routed and delivered messages (see EventTrace.h). There is one ingress
+	// record per copy of a message that enters the event queue, with the output node as
+	// channel and the total delay of the route (including the queueing delays).
+	EventTrace trace_;
+
+    // Random generator (standard normal samples, reproducible on all platforms).
+    NormalGenerator generator_;
+
+    // Empirical delay distribution (alias table), loaded in exitInitializationMode.
+    EmpiricalDistribution delayTable_;
 
+    // Variables of the FMU by type, sorted by value reference (see VariableTable.h).
+    // The variables of the input and output nodes are added at instantiation.
+    static const VariableDescription<Pipeline_configurable, fmi3Int32> int32Variables_[4];
+    static const VariableDescription<Pipeline_configurable, fmi3Float64> float64Variables_[3];
+    static const VariableDescription<Pipeline_configurable, fmi3UInt64> uInt64Variables_[6];
+    static const VariableDescription<Pipeline_configurable, fmi3Clock> clockVariables_[1];
+    static const VariableDescription<Pipeline_configurable, std::string> stringVariables_[1];
 };
 
 #endif // Pipeline_configurable_h
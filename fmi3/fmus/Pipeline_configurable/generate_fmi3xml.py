@@ -38,6 +38,10 @@ try:
     fmi_md_el = etree.Element('fmiModelDescription', fmiVersion='3.0-beta.1', modelName='Pipeline_configurable', instantiationToken='{e1059e19-5a7b-4dd8-8ee3-6ce4fd3e0cf8}')
     cosim_el = etree.SubElement(fmi_md_el, 'CoSimulation', modelIdentifier='Pipeline_configurable', canHandleVariableCommunicationStepSize='true',
                                 canReturnEarlyAfterIntermediateUpdate='true', hasEventMode='true')
+    log_cats_el = etree.SubElement(fmi_md_el, 'LogCategories')
+    for name, description in [('queue', 'Event queue operations'), ('step', 'Communication steps'), ('io', 'Getting and setting variables'),
+                              ('clock', 'Clocks and event times'), ('instance', 'Instantiation and life cycle')]:
+        etree.SubElement(log_cats_el, 'Category', name=name, description=description)
     mod_vars_el = etree.SubElement(fmi_md_el, 'ModelVariables')
     mod_struc_el = etree.SubElement(fmi_md_el, 'ModelStructure')
 
@@ -101,6 +105,40 @@ try:
     if mid_nodes_present:
         etree.SubElement(mod_vars_el, 'Clock', name='__DUMMY', valueReference='999', causality='output', variability='discrete', interval='triggered')
 
+    #parameters of the random generator, the time base and the event queue (same as Pipeline_deterministic).
+    etree.SubElement(mod_vars_el, 'Int32', name='randomSeed', valueReference='3001', causality='parameter', variability='fixed', start='4567')
+    etree.SubElement(mod_vars_el, 'Int32', name='ticksPerSecond', valueReference='3005', causality='parameter', variability='fixed', start='1000000000',
+                     description='Resolution of the internal time base')
+    etree.SubElement(mod_vars_el, 'Int32', name='eventScheduler', valueReference='3006', causality='parameter', variability='fixed', start='0',
+                     description='Event queue backend (0: heap, 1: timing wheel)')
+
+    #empirical delay distribution (file in the resource directory, empty: normal distribution).
+    dist_el = etree.SubElement(mod_vars_el, 'String', name='delayDistribution', valueReference='3007', causality='parameter', variability='fixed',
+                               description='File of an empirical delay distribution in the resource directory (histogram or CDF, empty: normal distributions from the delays and jitters of the pipes)')
+    etree.SubElement(dist_el, 'Start', value='')
+
+    #message size, transmission time on pipes with a limited bandwidth.
+    etree.SubElement(mod_vars_el, 'Int32', name='messageSize', valueReference='3008', causality='parameter', variability='fixed', start='1500',
+                     description='Size of the messages in bytes (transmission time on pipes with a limited bandwidth)')
+
+    #binary trace of the routed and delivered messages.
+    etree.SubElement(mod_vars_el, 'UInt64', name='traceCapacity', valueReference='3009', causality='parameter', variability='fixed', start='0',
+                     description='Number of records of the binary message trace (0: no trace)')
+
+    #statistics of the pipeline, updated with every message sent or delivered.
+    statistics=[('UInt64', 'queueDepth', 'Number of events in the event queue'),
+                ('UInt64', 'messagesInFlight', 'Number of messages sent and neither delivered nor dropped yet'),
+                ('UInt64', 'messagesSent', 'Total number of messages sent'),
+                ('UInt64', 'messagesDelivered', 'Total number of messages delivered'),
+                ('UInt64', 'messagesDropped', 'Total number of messages dropped'),
+                ('Float64', 'meanDelay', 'Mean of the sampled delays'),
+                ('Float64', 'maxDelay', 'Maximum of the sampled delays'),
+                ('Float64', 'lastDeliveryTime', 'Time of the last delivery (0 before the first delivery)')]
+    stat_count=4001
+    for var_type, name, description in statistics:
+        etree.SubElement(mod_vars_el, var_type, name=name, valueReference=str(stat_count), causality='output', variability='discrete', description=description)
+        stat_count+=1
+
     #write the XML file
     with open("FMI3.xml", "wb") as f:
         f.write(etree.tostring(fmi_md_el, encoding='utf-8', xml_declaration = True, pretty_print = True))
@@ -7,54 +7,67 @@
 #ifndef DeterministicEventQueue_h
 #define DeterministicEventQueue_h
 
-#include <set>
+#include <cstddef>
+#include <limits>
+
+#include "EventScheduler.h"
+#include "PayloadPool.h"
+#include "TickTime.h"
 
 namespace DeterministicEventQueue
 {
-	typedef fmi3Float64 TimeStamp;
+	typedef TickTime::Ticks TimeStamp;
 	typedef fmi3Float64 Tolerance;
 	typedef fmi3Int32 MessageID;
-	typedef fmi3Int32* Receiver;
-	typedef fmi3Clock* ReceiverClock;
-	typedef fmi3Boolean Valid;
+	typedef fmi3UInt16 Channel;
+	typedef PayloadPool::Handle Payload;
+
+	// Maximum number of channels of a pipeline (channels are indexed by 16-bit integers).
+	static const size_t maxChannels = static_cast<size_t>( std::numeric_limits<Channel>::max() ) + 1;
 
+	// Events are compact 16-byte records. The channel index selects the elements of the
+	// pipeline's output arrays (variable "out" and clock "out_clock"), the payload handle
+	// refers to the pipeline's payload pool.
 	struct Event {
 
-		TimeStamp timeStamp; // Each event is associated with a timestamp.
+		TimeStamp timeStamp; // Each event is associated with a timestamp (in ticks).
 		MessageID msgId; // Each event is associated with a message ID.
-		Receiver receiver; // Each message ID is associated to an output variable.
-		ReceiverClock clock; // Each output variable is associated to an output clock.
-		Valid valid; //Set to true upon event creation, set to false when event can be deleted
+		Channel channel; // Each event is associated with an output channel.
+		Payload payload; // Each event may carry a binary payload.
 
 		// Struct constructor.
 		Event(
             TimeStamp t,
             MessageID m,
-            Receiver r,
-            ReceiverClock c
+            Channel c,
+            Payload p = PayloadPool::none
         ) :
             timeStamp( t ),
             msgId( m ),
-            receiver( r ),
-            clock( c ),
-            valid ( fmi3True )
+            channel( c ),
+            payload( p )
         {}
 	};
 
-    static Tolerance tolerance = 1e-2;
+	static_assert( sizeof( Event ) == 16, "events are expected to be 16-byte records" );
+
+	// Default precision for matching communication points (seconds). Each pipeline instance
+	// keeps its own tolerance, which may be overridden in enterInitializationMode.
+	static const Tolerance defaultTolerance = 1e-2;
 
 	// This functor defines that events are sorted in the event queue according to their timestamp.
+	// Timestamps are integer ticks, hence the comparison is exact (strict weak ordering).
 	struct EventOrder {
 		bool operator() (
-            const Event* e1,
-            const Event* e2
+            const Event& e1,
+            const Event& e2
         ) const {
-			return e1->timeStamp < e2->timeStamp - DeterministicEventQueue::tolerance;
+			return e1.timeStamp < e2.timeStamp;
 		}
 	};
 
-	// This is the definition of the event queue.
-	typedef std::set<Event*, EventOrder> EventQueue;
+	// This is the definition of the event queue (events are stored by value).
+	typedef EventScheduler<Event, EventOrder> EventQueue;
 }
 
 #endif // DeterministicEventQueue_h
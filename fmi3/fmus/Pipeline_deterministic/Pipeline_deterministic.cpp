@@ -8,6 +8,7 @@
 #include <ostream>
 #include <iostream>
 #include <limits>
+#include <cstdlib>
 #include <algorithm>
 #include <stdexcept>
 
@@ -17,6 +18,54 @@
 
 using namespace DeterministicEventQueue;
 
+constexpr VariableDescription<Pipeline_deterministic, fmi3Int32> Pipeline_deterministic::int32Variables_[] = {
+    arrayVariable( vrIn_, &Pipeline_deterministic::in_, inputVariable ),
+    arrayVariable( vrOut_, &Pipeline_deterministic::out_, outputVariable ),
+    arrayVariable( vrOutBatch_, &Pipeline_deterministic::outBatch_, outputVariable ),
+    scalarVariable( vrOutCount_, &Pipeline_deterministic::outCount_, outputVariable ),
+    arrayVariable( vrOutBatchChannel_, &Pipeline_deterministic::outBatchChannel_, outputVariable ),
+    scalarVariable( vrRandomSeed_, &Pipeline_deterministic::randomSeed_, parameterVariable ),
+    scalarVariable( vrTicksPerSecond_, &Pipeline_deterministic::ticksPerSecond_, parameterVariable ),
+    scalarVariable( vrEventScheduler_, &Pipeline_deterministic::eventScheduler_, parameterVariable )
+};
+
+constexpr VariableDescription<Pipeline_deterministic, fmi3Float64> Pipeline_deterministic::float64Variables_[] = {
+    scalarVariable( vrEventResolution_, &Pipeline_deterministic::eventResolution_, parameterVariable ),
+    scalarVariable( vrRandomMean_, &Pipeline_deterministic::randomMean_, parameterVariable ),
+    scalarVariable( vrRandomStdDev_, &Pipeline_deterministic::randomStdDev_, parameterVariable ),
+    scalarVariable( vrRandomMin_, &Pipeline_deterministic::randomMin_, parameterVariable ),
+    scalarVariable( vrMeanDelay_, &Pipeline_deterministic::meanDelay_, outputVariable ),
+    scalarVariable( vrMaxDelay_, &Pipeline_deterministic::maxDelay_, outputVariable ),
+    scalarVariable( vrLastDeliveryTime_, &Pipeline_deterministic::lastDeliveryTime_, outputVariable )
+};
+
+constexpr VariableDescription<Pipeline_deterministic, fmi3UInt64> Pipeline_deterministic::uInt64Variables_[] = {
+    scalarVariable( vrBatchSize_, &Pipeline_deterministic::batchSize_, structuralParameterVariable ),
+    scalarVariable( vrNChannels_, &Pipeline_deterministic::nChannels_, structuralParameterVariable ),
+    scalarVariable( vrPayloadPoolSize_, &Pipeline_deterministic::payloadPoolSize_, structuralParameterVariable ),
+    scalarVariable( vrMaxPayloadSize_, &Pipeline_deterministic::maxPayloadSize_, structuralParameterVariable ),
+    scalarVariable( vrTraceCapacity_, &Pipeline_deterministic::traceCapacity_, parameterVariable ),
+    scalarVariable( vrQueueDepth_, &Pipeline_deterministic::queueDepth_, outputVariable ),
+    scalarVariable( vrMessagesInFlight_, &Pipeline_deterministic::messagesInFlight_, outputVariable ),
+    scalarVariable( vrMessagesSent_, &Pipeline_deterministic::messagesSent_, outputVariable ),
+    scalarVariable( vrMessagesDelivered_, &Pipeline_deterministic::messagesDelivered_, outputVariable ),
+    scalarVariable( vrMessagesDropped_, &Pipeline_deterministic::messagesDropped_, outputVariable )
+};
+
+constexpr VariableDescription<Pipeline_deterministic, fmi3Boolean> Pipeline_deterministic::booleanVariables_[] = {
+    arrayVariable( vrInActive_, &Pipeline_deterministic::inActive_, inputVariable ),
+    arrayVariable( vrOutActive_, &Pipeline_deterministic::outActive_, outputVariable )
+};
+
+constexpr VariableDescription<Pipeline_deterministic, fmi3Clock> Pipeline_deterministic::clockVariables_[] = {
+    scalarVariable( vrInClock_, &Pipeline_deterministic::inClock_, inputVariable ),
+    scalarVariable( vrOutClock_, &Pipeline_deterministic::outClock_, outputVariable )
+};
+
+constexpr VariableDescription<Pipeline_deterministic, std::string> Pipeline_deterministic::stringVariables_[] = {
+    scalarVariable( vrDelayDistribution_, &Pipeline_deterministic::delayDistribution_, parameterVariable )
+};
+
 Pipeline_deterministic::Pipeline_deterministic(
     fmi3String instanceName,
     fmi3String instantiationToken,
@@ -46,17 +95,44 @@ Pipeline_deterministic::Pipeline_deterministic(
         intermediateUpdate
     ),
     eventHappenedInternal(fmi3False),
-    in_( 0 ),
-    out_( 0 ),
+    in_( 1, 0 ),
+    inClock_( fmi3ClockInactive ),
+    inPayload_( 1, PayloadPool::none ),
+    inActive_( 1, fmi3True ),
+    out_( 1, 0 ),
+    outClock_( fmi3ClockInactive ),
+    outBatch_( 1, 0 ),
+    outCount_( 0 ),
+    outPayload_( 1, PayloadPool::none ),
+    outBatchPayload_( 1, PayloadPool::none ),
+    outBatchChannel_( 1, 0 ),
+    outActive_( 1, fmi3False ),
     eventResolution_ (1e-15),
     randomSeed_( 1 ),
     randomMean_( 0.5 ),
     randomStdDev_( 0.15 ),
     randomMin_( 0.1 ),
-    tolerance_( DeterministicEventQueue::tolerance ),
-    nextEventTime_( std::numeric_limits<fmi3Float64>::max() ),
-    eventQueue_(),
-    currentEvent_( eventQueue_.end() )
+    ticksPerSecond_( 1000000000 ),
+    eventScheduler_( EventQueue::heap ),
+    batchSize_( 1 ),
+    nChannels_( 1 ),
+    payloadPoolSize_( 0 ),
+    maxPayloadSize_( 1024 ),
+    traceCapacity_( 0 ),
+    queueDepth_( 0 ),
+    messagesInFlight_( 0 ),
+    messagesSent_( 0 ),
+    messagesDelivered_( 0 ),
+    messagesDropped_( 0 ),
+    meanDelay_( 0. ),
+    maxDelay_( 0. ),
+    lastDeliveryTime_( 0. ),
+    startTime_( 0. ),
+    syncTime_( 0 ),
+    nextEventTime_( TickTime::never ),
+    tolerance_( DeterministicEventQueue::defaultTolerance ),
+    toleranceTicks_( 0 ),
+    eventQueue_()
 {
     if ( fmi3False == this->getEventModeUsed() )
     {
@@ -73,8 +149,22 @@ Pipeline_deterministic::Pipeline_deterministic(
         throw std::runtime_error( "Wrong GUID (instantiation token)." );
     }
 
+    // Bind the variables of the FMU (value references must match FMI3.xml).
+    static_assert( hasIncreasingValueReferences( int32Variables_ ), "int32 variables must be sorted by value reference" );
+    this->int32Table_.bind( this, int32Variables_ );
+    static_assert( hasIncreasingValueReferences( float64Variables_ ), "float64 variables must be sorted by value reference" );
+    this->float64Table_.bind( this, float64Variables_ );
+    static_assert( hasIncreasingValueReferences( uInt64Variables_ ), "uInt64 variables must be sorted by value reference" );
+    this->uInt64Table_.bind( this, uInt64Variables_ );
+    static_assert( hasIncreasingValueReferences( booleanVariables_ ), "boolean variables must be sorted by value reference" );
+    this->booleanTable_.bind( this, booleanVariables_ );
+    static_assert( hasIncreasingValueReferences( clockVariables_ ), "clock variables must be sorted by value reference" );
+    this->clockTable_.bind( this, clockVariables_ );
+    static_assert( hasIncreasingValueReferences( stringVariables_ ), "string variables must be sorted by value reference" );
+    this->stringTable_.bind( this, stringVariables_ );
+
     this->logDebug(
-        "successfully initialized class %s", "Pipeline_deterministic"
+        logInstance, "successfully initialized class %s", "Pipeline_deterministic"
     );
 }
 
@@ -86,15 +176,37 @@ Pipeline_deterministic::enterInitializationMode(
     fmi3Boolean stopTimeDefined,
     fmi3Float64 stopTime
 ) {
+    // The number of channels is a structural parameter, it is fixed from now on.
+    if ( ( 1 > this->nChannels_ ) || ( maxChannels < this->nChannels_ ) )
+    {
+        this->logError( "Invalid number of channels: %llu", static_cast<unsigned long long>( this->nChannels_ ) );
+        return fmi3Error;
+    }
+
+    this->in_.assign( this->nChannels_, 0 );
+    this->inActive_.assign( this->nChannels_, fmi3True );
+    this->out_.assign( this->nChannels_, 0 );
+    this->outActive_.assign( this->nChannels_, fmi3False );
+
+    // The payload pool is allocated once, payloads are never allocated per message.
+    if ( PayloadPool::maxSlots < this->payloadPoolSize_ )
+    {
+        this->logError( "Invalid payload pool size: %llu", static_cast<unsigned long long>( this->payloadPoolSize_ ) );
+        return fmi3Error;
+    }
+
+    this->payloadPool_.allocate( this->payloadPoolSize_, this->maxPayloadSize_ );
+    this->inPayload_.assign( this->nChannels_, PayloadPool::none );
+    this->outPayload_.assign( this->nChannels_, PayloadPool::none );
+
     this->setMode( initializationMode );
 
-    // Set internal time to simulation start time.
-    this->syncTime_ = startTime;
+    // Simulation start time, converted to ticks when the time base is fixed.
+    this->startTime_ = startTime;
 
-    // Adjust tolerances for determining if two timestamps are the same.
+    // Adjust the precision for matching the importer's communication points.
     if ( fmi3True == toleranceDefined )
     {
-        DeterministicEventQueue::tolerance = tolerance;
         this->tolerance_ = tolerance;
     }
 
@@ -104,8 +216,38 @@ Pipeline_deterministic::enterInitializationMode(
 fmi3Status
 Pipeline_deterministic::exitInitializationMode()
 {
+    // Time base must have a positive resolution.
+    if ( 1 > this->ticksPerSecond_ )
+    {
+        this->logError( "Invalid number of ticks per second: %d", this->ticksPerSecond_ );
+        return fmi3Error;
+    }
+
+    if ( false == EventQueue::isValidBackend( this->eventScheduler_ ) )
+    {
+        this->logError( "Invalid event queue backend: %d", this->eventScheduler_ );
+        return fmi3Error;
+    }
+
+    // Select the event queue backend.
+    this->eventQueue_.setBackend( static_cast<EventQueue::Backend>( this->eventScheduler_ ) );
+
+    if ( 1 > this->batchSize_ )
+    {
+        this->logError( "Invalid batch size: %llu", static_cast<unsigned long long>( this->batchSize_ ) );
+        return fmi3Error;
+    }
+
+    this->outBatch_.assign( this->batchSize_, 0 );
+    this->outBatchPayload_.assign( this->batchSize_, PayloadPool::none );
+    this->outBatchChannel_.assign( this->batchSize_, 0 );
+
     this->setMode( stepMode );
 
+    // Set internal time to simulation start time.
+    this->syncTime_ = this->toTicks( this->startTime_ );
+    this->toleranceTicks_ = this->toTicks( this->tolerance_ );
+
 	// Random generator seed has to be a positive non-zero integer.
 	if ( 1 > this->randomSeed_ )
     {
@@ -115,11 +257,38 @@ Pipeline_deterministic::exitInitializationMode()
     // Set random generator seed.
     this->generator_.seed( this->randomSeed_ );
 
-    // Initialize random number distribution.
-    this->distribution_ = std::normal_distribution<fmi3Float64>(
-        this->randomMean_,
-        this->randomStdDev_
-    );
+    // Build the alias table of the empirical delay distribution.
+    if ( this->delayDistribution_.empty() )
+    {
+        this->delayTable_.clear();
+    }
+    else
+    {
+        std::string error;
+        if ( false == this->delayTable_.load( this->getResourceFile( this->delayDistribution_ ), error ) )
+        {
+            this->logError( "Invalid delay distribution: %s", error.c_str() );
+            return fmi3Error;
+        }
+
+        this->logDebug(
+            logInstance, "empirical delay distribution with %zu bins (mean %g s)",
+            this->delayTable_.size(), this->delayTable_.mean()
+        );
+    }
+
+    // Open the message trace "<instance name>.trace" in the directory given by the environment
+    // variable FMU_TRACE_DIR (default: resource directory).
+    if ( 0 < this->traceCapacity_ )
+    {
+        const std::string path = this->getOutputFile( this->getInstanceName() + ".trace", "FMU_TRACE_DIR" );
+
+        if ( false == this->trace_.open( path, this->traceCapacity_, this->ticksPerSecond_ ) )
+        {
+            this->logError( "Cannot create message trace %s", path.c_str() );
+            return fmi3Error;
+        }
+    }
 
     return fmi3OK;
 }
@@ -137,245 +306,95 @@ Pipeline_deterministic::enterEventMode(
     // This is a time event that was previously signaled by function doStep.
     // This means that a new message is available to be received by the importer.
     //std::cout << "  eventHappenedInternal=" << this->eventHappenedInternal << std::endl << std::flush;
-    if ( fmi3True == this->eventHappenedInternal )
+    // All messages due at the current event time are delivered at once (up to the batch size).
+    // The first message of each channel is written to the channel's element of "out" (and
+    // flagged in "outActive"), all of them are written to "outBatch" (with their channels in
+    // "outBatchChannel" and their payloads in "outBatchPayload"). Remaining
+    // messages with the same timestamp are delivered in the next event iteration.
+    if ( ( fmi3True == this->eventHappenedInternal ) && ( false == this->eventQueue_.empty() ) )
     {
-        *( *this->currentEvent_ )->receiver = ( *this->currentEvent_ )->msgId;
-        *( *this->currentEvent_ )->clock = fmi3ClockActive;
-        ( *this->currentEvent_ )->valid=fmi3False;
-    }
+        const TimeStamp eventTime = this->eventQueue_.top().timeStamp;
+        size_t count = 0;
 
-    return fmi3OK;
-}
-
-fmi3Status
-Pipeline_deterministic::reset()
-{
-    this->eventQueue_.clear();
-    this->currentEvent_ = this->eventQueue_.end();
-    this->nextEventTime_ = std::numeric_limits<fmi3Float64>::max();
-
-    return fmi3OK;
-}
-
-fmi3Status
-Pipeline_deterministic::getInt32(
-    const fmi3ValueReference valueReferences[],
-    size_t nValueReferences,
-    fmi3Int32 values[],
-    size_t nValues
-) {
-    if ( nValueReferences != nValues ) {
-        this->logError(
-            "%s %s",
-            "This FMU only supports scalar variables.",
-            "The number of value references and values must match!"
-        );
-        return fmi3Error;
-    }
-
-    fmi3Status status = fmi3OK;
-    const fmi3ValueReference* vr;
-    fmi3Int32* v;
-
-    for (
-        vr = valueReferences, v = values;
-        vr != valueReferences + nValues, v != values + nValues;
-        ++vr, ++v
-    ) {
-        switch ( *vr ) {
-            case this->vrOut_:
-                *v = this->out_;
-                this->logDebug( "%d => get %d", *vr, this->out_ );
-                break;
-            default:
-                this->logError( "Invalid value reference: %d", *vr );
-                status = fmi3Error;
+        // Payloads of the previous batch are released.
+        for ( Payload& payload : this->outBatchPayload_ )
+        {
+            this->payloadPool_.removeReference( payload );
+            payload = PayloadPool::none;
         }
-    }
-
-    return status;
-}
 
-fmi3Status
-Pipeline_deterministic::getClock(
-    const fmi3ValueReference valueReferences[],
-    size_t nValueReferences,
-    fmi3Clock values[]
-) {
-    //std::cout << ">> Pipeline_deterministic::getClock" << std::endl << std::flush;
-    /*if ( nValueReferences != nValues ) {
-        this->logError(
-            "%s %s",
-            "This FMU only supports scalar variables.",
-            "The number of value references and values must match!"
-        );
-        return fmi3Error;
-    }*/
-
-    fmi3Status status = fmi3OK;
-    const fmi3ValueReference* vr;
-    fmi3Clock* v;
-
-    for (
-        vr = valueReferences, v = values;
-        vr != valueReferences + nValueReferences, v != values + nValueReferences;
-        ++vr, ++v
-    ) {
-        switch ( *vr ) {
-            case this->vrOutClock_:
-                *v = this->outClock_;
-                this->logDebug( "%d => get clock %d", *vr, this->outClock_ );
-                break;
-            default:
-                this->logError( "Invalid value reference: %d", *vr );
-                status = fmi3Error;
-        }
-    }
+        do
+        {
+            const Event& evt = this->eventQueue_.top();
+            this->trace_.recordEgress( this->syncTime_, evt.msgId, evt.channel );
+
+            // The batch takes over the event's reference to the payload, the channel's output
+            // variable adds its own.
+            if ( fmi3False == this->outActive_[ evt.channel ] )
+            {
+                this->out_[ evt.channel ] = evt.msgId;
+                this->outActive_[ evt.channel ] = fmi3True;
+                this->payloadPool_.removeReference( this->outPayload_[ evt.channel ] );
+                this->payloadPool_.addReference( evt.payload );
+                this->outPayload_[ evt.channel ] = evt.payload;
+            }
 
-    return status;
-}
+            this->outBatchPayload_[ count ] = evt.payload;
+            this->outBatchChannel_[ count ] = evt.channel;
+            this->outBatch_[ count++ ] = evt.msgId;
 
-fmi3Status
-Pipeline_deterministic::setInt32(
-    const fmi3ValueReference valueReferences[],
-    size_t nValueReferences,
-    const fmi3Int32 values[],
-    size_t nValues
-) {
-    if ( nValueReferences != nValues ) {
-        this->logError(
-            "%s %s",
-            "This FMU only supports scalar variables.",
-            "The number of value references and values must match!"
-        );
-        return fmi3Error;
-    }
-
-    fmi3Status status = fmi3OK;
-    const fmi3ValueReference* vr;
-    const fmi3Int32* v;
-
-    for (
-        vr = valueReferences, v = values;
-        vr != valueReferences + nValues, v != values + nValues;
-        ++vr, ++v
-    ) {
-        switch ( *vr ) {
-            case this->vrIn_:
-                this->in_ = *v;
-                break;
-            case this->vrRandomSeed_:
-                this->randomSeed_ = *v;
-                break;
-            default:
-                this->logError( "Invalid value reference: %d", *vr );
-                status = fmi3Error;
+            // The event has been delivered, remove it from the queue.
+            this->eventQueue_.pop();
+            this->recordDelivered();
         }
+        while (
+            ( count < this->batchSize_ ) &&
+            ( false == this->eventQueue_.empty() ) &&
+            ( eventTime == this->eventQueue_.top().timeStamp )
+        );
 
-        this->logDebug( "Value reference %d => set to: %d (fmi3Int32)", *vr, *v );
+        this->outCount_ = static_cast<fmi3Int32>( count );
+        this->outClock_ = fmi3ClockActive;
+        this->eventHappenedInternal = fmi3False;
     }
 
-    return status;
+    return fmi3OK;
 }
 
 fmi3Status
-Pipeline_deterministic::setFloat64(
-    const fmi3ValueReference valueReferences[],
-    size_t nValueReferences,
-    const fmi3Float64 values[],
-    size_t nValues
-) {
-    if ( nValueReferences != nValues ) {
-        this->logError(
-            "%s %s",
-            "This FMU only supports scalar variables.",
-            "The number of value references and values must match!"
-        );
-        return fmi3Error;
-    }
+Pipeline_deterministic::terminate()
+{
+    this->logDebug(
+        logQueue, "event queue high-water mark: %zu events", this->eventQueue_.highWaterMark()
+    );
 
-    fmi3Status status = fmi3OK;
-    const fmi3ValueReference* vr;
-    const fmi3Float64* v;
-
-    for (
-        vr = valueReferences, v = values;
-        vr != valueReferences + nValues, v != values + nValues;
-        ++vr, ++v
-    ) {
-        switch ( *vr ) {
-            case this->vrEventResolution_:
-                this->eventResolution_ = *v;
-                break;
-            case this->vrRandomMean_:
-                this->randomMean_ = *v;
-                break;
-            case this->vrRandomStdDev_:
-                this->randomStdDev_ = *v;
-                break;
-            case this->vrRandomMin_:
-                this->randomMin_ = *v;
-                break;
-            default:
-                this->logError( "Invalid value reference: %d", *vr );
-                status = fmi3Error;
-        }
+    this->logDebug(
+        logQueue, "payload pool high-water mark: %zu payloads", this->payloadPool_.highWaterMark()
+    );
 
-        this->logDebug( 
-            "Value reference %d => set to: %f (fmi3Float64)", *vr, *v 
-        );
-    }
+    this->trace_.close();
 
-    return status;
+    return InstanceBase::terminate();
 }
 
 fmi3Status
-Pipeline_deterministic::setClock(
-    const fmi3ValueReference valueReferences[],
-    size_t nValueReferences,
-    const fmi3Clock values[])
+Pipeline_deterministic::reset()
 {
-    //std::cout << ">> Pipeline_deterministic::setClock" << std::endl << std::flush;
-/*    if ( nValueReferences != nValues ) {
-        this->logError(
-            "%s %s",
-            "This FMU only supports scalar variables.",
-            "The number of value references and values must match!"
-        );
-        return fmi3Error;
-    }*/
-
-    fmi3Status status = fmi3OK;
-    const fmi3ValueReference* vr;
-    const fmi3Clock* v;
-
-    for (
-        vr = valueReferences, v = values;
-        vr != valueReferences + nValueReferences, v != values + nValueReferences;
-        ++vr, ++v
-    ) {
-        switch ( *vr ) {
-            case this->vrInClock_:
-                if ( fmi3ClockInactive == *v )
-                {
-                    this->logError(
-                        "clocks may not be deactivated by the importer"
-                    );
-                    return fmi3Error;
-                }
-                this->inClock_ = *v;
-                break;
-            default:
-                this->logError( "Invalid value reference: %d", *vr );
-                status = fmi3Error;
-        }
+    this->logDebug(
+        logQueue, "event queue high-water mark: %zu events", this->eventQueue_.highWaterMark()
+    );
 
-        this->logDebug( 
-            "%d => set clock %d", *vr, *v
-        );
-    }
+    this->eventQueue_.release();
+    this->nextEventTime_ = TickTime::never;
+
+    this->payloadPool_.release();
+    this->trace_.close();
+    this->resetStatistics();
+    this->inPayload_.assign( this->inPayload_.size(), PayloadPool::none );
+    this->outPayload_.assign( this->outPayload_.size(), PayloadPool::none );
+    this->outBatchPayload_.assign( this->outBatchPayload_.size(), PayloadPool::none );
 
-    return status;
+    return fmi3OK;
 }
 
 fmi3Status
@@ -388,80 +407,55 @@ Pipeline_deterministic::updateDiscreteStates(
     fmi3Float64 *nextEventTime
 ) {
     // Input clock is active --> add message as output using the calculated delay.
-    if ( fmi3ClockActive == this->inClock_ ) {
-
-        fmi3Float64 delay;
-        
-        // The event queue can only contain one event per timestamp. Since there is
-        // a (very small) chance that we generate a new random event with an already
-        // existing timestamp, insertion of new event is repeated until a new event
-        // has been inserted successfully.
-        do
+    // Each active channel draws its own delay (in the order of the channels). Every message
+    // is inserted exactly once. Messages that become due at the same time are delivered in
+    // the order of their arrival.
+    for ( size_t c = 0; ( fmi3ClockActive == this->inClock_ ) && ( c < this->in_.size() ); ++c )
+    {
+        if ( fmi3True == this->inActive_[c] )
         {
-            delay = this->calculateDelay();
-        } 
-        while( false == this->addNewEvent(
-            this->syncTime_ + delay,
-            this->in_,
-            &this->out_,
-            &this->outClock_
-        ) );
+            TimeStamp delay = this->calculateDelay();
+            this->trace_.recordIngress( this->syncTime_, delay, this->in_[c], static_cast<Channel>( c ) );
+
+            this->addNewEvent(
+                this->syncTime_ + delay,
+                this->in_[c],
+                static_cast<Channel>( c ),
+                this->inPayload_[c]
+            );
+
+            this->recordSent( delay );
+        }
     }
 
     // Event queue is empty, next event time is undefined.
     if ( this->eventQueue_.empty() )
-    //if (( this->currentEvent_ == this->eventQueue_.end() ) || (*nextEventTimeDefined == fmi3False))
     {
-        this->nextEventTime_ = std::numeric_limits<fmi3Float64>::max();
+        this->nextEventTime_ = TickTime::never;
         *nextEventTimeDefined = fmi3False;
+        *nextEventTime = std::numeric_limits<fmi3Float64>::max();
+
+        this->logDebug(
+            logClock, "no next event defined"
+        );
     }
-    // We have not yet reached the next event, return the next event's time.
-    else if ( this->syncTime_ < this->nextEventTime_ - this->tolerance_ )
+    // Delivered events have already been removed, the earliest remaining event is next.
+    else
     {
-        this->nextEventTime_ = ( *this->currentEvent_ )->timeStamp;
+        this->nextEventTime_ = this->eventQueue_.top().timeStamp;
         *nextEventTimeDefined = fmi3True;
-    }
-    // We are processing the current event, increment event if possible.
-    else if ( fabs( this->syncTime_ - this->nextEventTime_ ) <= this->tolerance_ )
-    {
-        // There is a next event in the schedule --> increment current event and set
-        // time of this event as next event time.
-        if ( this->currentEvent_ != std::prev( this->eventQueue_.end() ) )
-        {
-            DeterministicEventQueue::EventQueue::iterator deletePos=currentEvent_;
-            ++( this->currentEvent_ );
-            eventQueue_.erase(deletePos);
+        *nextEventTime = this->toSeconds( this->nextEventTime_ );
 
-            this->nextEventTime_ = ( *this->currentEvent_ )->timeStamp;
-            *nextEventTimeDefined = fmi3True;
-
-            this->logDebug(
-                "set next event time to t = %f",
-                this->nextEventTime_
-            );
-        }
-        else // There is NO next event in the schedule, next event time is undefined.
-        {
-            this->nextEventTime_ = std::numeric_limits<fmi3Float64>::max();
-            *nextEventTimeDefined = fmi3False;
-            if ( this->currentEvent_ != this->eventQueue_.end() ) {
-                if (( *this->currentEvent_ )->valid==fmi3False) {
-                    DeterministicEventQueue::EventQueue::iterator deletePos=currentEvent_;
-                    ++( this->currentEvent_ );
-                    eventQueue_.erase(deletePos);
-                }
-            }
-            this->logDebug(
-                "no next event defined"
-            );
-        }
+        this->logDebug(
+            logClock, "set next event time to t = %f",
+            *nextEventTime
+        );
     }
 
     *discreteStatesNeedUpdate = fmi3False;
     *terminateSimulation = fmi3False;
     *nominalsOfContinuousStatesChanged = fmi3False;
     *valuesOfContinuousStatesChanged = fmi3False;
-    *nextEventTime = this->nextEventTime_;
 
     // We have finished processing internal events --> deactivate all active clocks.
     this->deactivateAllClocks();
@@ -481,48 +475,49 @@ Pipeline_deterministic::doStep(
 ) {
     // Sanity check: Do the importer's current communication point and the internal
     // synchronization time coincide?
-    if ( fabs( this->syncTime_ - currentCommunicationPoint ) > (this->tolerance_*1.000001) )
+    TickTime::Ticks currentTime = this->toTicks( currentCommunicationPoint );
+    if ( std::llabs( this->syncTime_ - currentTime ) > this->toleranceTicks_ )
     {
-        std::cout << "Current communication point (" << currentCommunicationPoint << ") does not coincide with the internal time (" << this->syncTime_ << ") " << " within tolerance " << this->tolerance_ << "." << std::endl;
-        //this->logError(
-        //    "Current communication point (%f) does not coincide with the internal time (%f)",
-        //    currentCommunicationPoint, this->syncTime_
-        //);
+        this->logError(
+            "Current communication point (%f) does not coincide with the internal time (%f)",
+            currentCommunicationPoint, this->toSeconds( this->syncTime_ )
+        );
 
         return fmi3Discard;
     }
 
-    // Update internal synchronization time to new requested communication point.
-    this->syncTime_ = currentCommunicationPoint + communicationStepSize;
+    // New requested communication point.
+    TickTime::Ticks targetTime = this->toTicks( currentCommunicationPoint + communicationStepSize );
     this->logDebug(
-        "Attempt to step from %f to %f",
+        logStep, "Attempt to step from %f to %f",
         currentCommunicationPoint,
-        this->syncTime_
+        currentCommunicationPoint + communicationStepSize
     );
 
-    // The importer stepped over an event.
-    if ( this->syncTime_ > (this->nextEventTime_-tolerance) )
+    // The importer stepped over an event --> return early at the event time.
+    if ( targetTime > this->nextEventTime_ )
     {
+        this->syncTime_ = this->nextEventTime_;
         this->logDebug(
-            "%s %s %f",
+            logStep, "%s %s %f",
             "The importer stepped over an event.",
             "The current internal time (lastSuccessfulTime) is: ",
-            this->nextEventTime_
+            this->toSeconds( this->syncTime_ )
         );
 
         *eventEncountered = fmi3True;
         eventHappenedInternal = fmi3True;
         *earlyReturn = fmi3True;
-        *lastSuccessfulTime = this->nextEventTime_;
+        *lastSuccessfulTime = this->toSeconds( this->syncTime_ );
     }
-    // The importer has reached the next event.
-    else if ( fabs( this->syncTime_ - this->nextEventTime_ ) <= this->tolerance_ )
+    // The importer has reached the next event (within tolerance).
+    else if ( targetTime >= this->nextEventTime_ - this->toleranceTicks_ )
     {
         this->logDebug(
-            "The importer has reached the next event at the new synchronization point."
+            logStep, "The importer has reached the next event at the new synchronization point."
         );
 
-        if ( this->currentEvent_ == this->eventQueue_.end() )
+        if ( this->eventQueue_.empty() )
         {
             this->logError(
                 "corrupted event queue"
@@ -532,21 +527,24 @@ Pipeline_deterministic::doStep(
             return fmi3Fatal;
         }
 
+        this->syncTime_ = this->nextEventTime_;
+
         *eventEncountered = fmi3True;
         eventHappenedInternal = fmi3True;
         *earlyReturn = fmi3False;
-        *lastSuccessfulTime = this->syncTime_;
+        *lastSuccessfulTime = this->toSeconds( this->syncTime_ );
     }
     else // The importer has not yet reached the next event.
     {
+        this->syncTime_ = targetTime;
         this->logDebug(
-            "The importer has not yet reached the next event."
+            logStep, "The importer has not yet reached the next event."
         );
 
         *eventEncountered = fmi3False;
         eventHappenedInternal = fmi3False;
         *earlyReturn = fmi3False;
-        *lastSuccessfulTime = this->syncTime_;
+        *lastSuccessfulTime = this->toSeconds( this->syncTime_ );
     }
 
     *terminateSimulation = fmi3False;
@@ -554,67 +552,528 @@ Pipeline_deterministic::doStep(
     return fmi3OK;
 }
 
-bool
-Pipeline_deterministic::addNewEvent(
-    const TimeStamp& msgReceiveTime,
-    const MessageID& msgId,
-    const Receiver& receiver,
-    const ReceiverClock& clock
+fmi3Status
+Pipeline_deterministic::getBinary(
+    const fmi3ValueReference valueReferences[],
+    size_t nValueReferences,
+    size_t sizes[],
+    fmi3Binary values[],
+    size_t nValues
 ) {
-    bool firstEvent = this->eventQueue_.empty();
-
-    // Create new event.
-    Event* evt = new Event(
-        msgReceiveTime,
-        msgId,
-        receiver,
-        clock
-    );
+    // Payloads are not copied, the importer gets pointers into the payload pool.
+    size_t n = 0;
 
-    this->logDebug(
-        "add new event at t = %f - id = %d", msgReceiveTime, msgId
+    for ( size_t i = 0; i < nValueReferences; ++i )
+    {
+        const std::vector<Payload>* payloads = this->findPayloadVariable( valueReferences[i] );
+
+        if ( nullptr == payloads )
+        {
+            this->logError( "Invalid value reference: %d", valueReferences[i] );
+            return fmi3Error;
+        }
+
+        if ( nValues - n < payloads->size() )
+        {
+            this->logError( "The number of values does not match the value references!" );
+            return fmi3Error;
+        }
+
+        for ( size_t c = 0; c < payloads->size(); ++c, ++n )
+        {
+            values[n] = this->payloadPool_.data( ( *payloads )[c] );
+            sizes[n] = this->payloadPool_.size( ( *payloads )[c] );
+        }
+    }
+
+    if ( n != nValues )
+    {
+        this->logError( "The number of values does not match the value references!" );
+        return fmi3Error;
+    }
+
+    return fmi3OK;
+}
+
+fmi3Status
+Pipeline_deterministic::setBinary(
+    const fmi3ValueReference valueReferences[],
+    size_t nValueReferences,
+    const size_t sizes[],
+    const fmi3Binary values[],
+    size_t nValues
+) {
+    // Payloads are copied into the payload pool once, empty payloads take no space.
+    size_t n = 0;
+
+    for ( size_t i = 0; i < nValueReferences; ++i )
+    {
+        if ( ( vrOutPayload_ == valueReferences[i] ) || ( vrOutBatchPayload_ == valueReferences[i] ) )
+        {
+            this->logError( "Output variable %d cannot be set", valueReferences[i] );
+            return fmi3Error;
+        }
+
+        if ( vrInPayload_ != valueReferences[i] )
+        {
+            this->logError( "Invalid value reference: %d", valueReferences[i] );
+            return fmi3Error;
+        }
+
+        if ( nValues - n < this->inPayload_.size() )
+        {
+            this->logError( "The number of values does not match the value references!" );
+            return fmi3Error;
+        }
+
+        for ( size_t c = 0; c < this->inPayload_.size(); ++c, ++n )
+        {
+            Payload payload = PayloadPool::none;
+
+            if ( 0 != sizes[n] )
+            {
+                if ( this->payloadPool_.slotSize() < sizes[n] )
+                {
+                    this->logError( "Payload of %zu bytes exceeds the maximum payload size", sizes[n] );
+                    return fmi3Error;
+                }
+
+                payload = this->payloadPool_.acquire( values[n], sizes[n] );
+
+                if ( PayloadPool::none == payload )
+                {
+                    this->logError( "Payload pool is exhausted (%zu payloads)", this->payloadPool_.capacity() );
+                    return fmi3Error;
+                }
+            }
+
+            this->payloadPool_.removeReference( this->inPayload_[c] );
+            this->inPayload_[c] = payload;
+        }
+    }
+
+    if ( n != nValues )
+    {
+        this->logError( "The number of values does not match the value references!" );
+        return fmi3Error;
+    }
+
+    return fmi3OK;
+}
+
+fmi3Status
+Pipeline_deterministic::getFMUState(
+    fmi3FMUState* fmuState
+) {
+    // Payloads are held by the payload pool, which is not part of the snapshot.
+    if ( 0 < this->payloadPool_.capacity() )
+    {
+        this->logError( "FMU states are not supported with payloads (payloadPoolSize > 0)" );
+        return fmi3Error;
+    }
+
+    // An existing state is overwritten.
+    State* state = static_cast<State*>( *fmuState );
+    if ( nullptr == state )
+    {
+        state = new State();
+    }
+
+    this->saveState( *state );
+    *fmuState = state;
+
+    return fmi3OK;
+}
+
+fmi3Status
+Pipeline_deterministic::setFMUState(
+    fmi3FMUState fmuState
+) {
+    if ( nullptr == fmuState )
+    {
+        this->logError( "Invalid FMU state" );
+        return fmi3Error;
+    }
+
+    this->restoreState( *static_cast<const State*>( fmuState ) );
+
+    return fmi3OK;
+}
+
+fmi3Status
+Pipeline_deterministic::freeFMUState(
+    fmi3FMUState* fmuState
+) {
+    delete static_cast<State*>( *fmuState );
+    *fmuState = nullptr;
+
+    return fmi3OK;
+}
+
+fmi3Status
+Pipeline_deterministic::serializedFMUStateSize(
+    fmi3FMUState fmuState,
+    size_t* size
+) {
+    if ( nullptr == fmuState )
+    {
+        this->logError( "Invalid FMU state" );
+        return fmi3Error;
+    }
+
+    StateSerialization::Writer counter( nullptr, 0 );
+    this->serializeState( *static_cast<const State*>( fmuState ), counter );
+    *size = counter.size();
+
+    return fmi3OK;
+}
+
+fmi3Status
+Pipeline_deterministic::serializeFMUState(
+    fmi3FMUState fmuState,
+    fmi3Byte serializedState[],
+    size_t size
+) {
+    if ( nullptr == fmuState )
+    {
+        this->logError( "Invalid FMU state" );
+        return fmi3Error;
+    }
+
+    // The state is written directly into the importer's buffer.
+    StateSerialization::Writer writer( serializedState, size );
+    this->serializeState( *static_cast<const State*>( fmuState ), writer );
+
+    if ( false == writer.ok() )
+    {
+        this->logError( "Buffer too small for the serialized FMU state (%zu bytes required)", writer.size() );
+        return fmi3Error;
+    }
+
+    return fmi3OK;
+}
+
+fmi3Status
+Pipeline_deterministic::deSerializeFMUState(
+    const fmi3Byte serializedState[],
+    size_t size,
+    fmi3FMUState* fmuState
+) {
+    // An existing state is overwritten.
+    State* state = static_cast<State*>( *fmuState );
+    if ( nullptr == state )
+    {
+        state = new State();
+    }
+
+    StateSerialization::Reader reader( serializedState, size );
+
+    if ( false == this->deserializeState( reader, *state ) )
+    {
+        if ( state != *fmuState ) delete state;
+
+        this->logError( "Invalid serialized FMU state" );
+        return fmi3Error;
+    }
+
+    *fmuState = state;
+
+    return fmi3OK;
+}
+
+void
+Pipeline_deterministic::saveState( State& state ) const
+{
+    state.mode = this->getMode();
+    state.eventHappenedInternal = this->eventHappenedInternal;
+    state.in = this->in_;
+    state.inClock = this->inClock_;
+    state.inActive = this->inActive_;
+    state.out = this->out_;
+    state.outClock = this->outClock_;
+    state.outActive = this->outActive_;
+    state.outBatch = this->outBatch_;
+    state.outBatchChannel = this->outBatchChannel_;
+    state.outCount = this->outCount_;
+    state.messagesSent = this->messagesSent_;
+    state.messagesDelivered = this->messagesDelivered_;
+    state.messagesDropped = this->messagesDropped_;
+    state.meanDelay = this->meanDelay_;
+    state.maxDelay = this->maxDelay_;
+    state.lastDeliveryTime = this->lastDeliveryTime_;
+    state.syncTime = this->syncTime_;
+    state.nextEventTime = this->nextEventTime_;
+    state.eventQueue = this->eventQueue_;
+    state.generator = this->generator_;
+}
+
+void
+Pipeline_deterministic::restoreState( const State& state )
+{
+    this->setMode( state.mode );
+    this->eventHappenedInternal = state.eventHappenedInternal;
+    this->in_ = state.in;
+    this->inClock_ = state.inClock;
+    this->inActive_ = state.inActive;
+    this->out_ = state.out;
+    this->outClock_ = state.outClock;
+    this->outActive_ = state.outActive;
+    this->outBatch_ = state.outBatch;
+    this->outBatchChannel_ = state.outBatchChannel;
+    this->outCount_ = state.outCount;
+    this->messagesSent_ = state.messagesSent;
+    this->messagesDelivered_ = state.messagesDelivered;
+    this->messagesDropped_ = state.messagesDropped;
+    this->meanDelay_ = state.meanDelay;
+    this->maxDelay_ = state.maxDelay;
+    this->lastDeliveryTime_ = state.lastDeliveryTime;
+    this->syncTime_ = state.syncTime;
+    this->nextEventTime_ = state.nextEventTime;
+    this->eventQueue_ = state.eventQueue;
+    this->generator_ = state.generator;
+
+    this->queueDepth_ = this->eventQueue_.size();
+    this->messagesInFlight_ = this->messagesSent_ - this->messagesDelivered_ - this->messagesDropped_;
+}
+
+void
+Pipeline_deterministic::serializeState(
+    const State& state,
+    StateSerialization::Writer& writer
+) const {
+    writer.putHeader( INSTANTIATION_TOKEN );
+    writer.put<int32_t>( state.mode );
+    writer.put<uint8_t>( state.eventHappenedInternal );
+
+    // Channel variables (the number of channels and the batch size are structural parameters).
+    writer.put<uint8_t>( state.inClock );
+    writer.put<uint8_t>( state.outClock );
+    writer.put<uint64_t>( state.in.size() );
+    for ( size_t c = 0; c < state.in.size(); ++c )
+    {
+        writer.put<int32_t>( state.in[c] );
+        writer.put<uint8_t>( state.inActive[c] );
+        writer.put<int32_t>( state.out[c] );
+        writer.put<uint8_t>( state.outActive[c] );
+    }
+
+    writer.put<uint64_t>( state.outBatch.size() );
+    for ( size_t i = 0; i < state.outBatch.size(); ++i )
+    {
+        writer.put<int32_t>( state.outBatch[i] );
+        writer.put<uint16_t>( state.outBatchChannel[i] );
+    }
+    writer.put<int32_t>( state.outCount );
+
+    writer.put<uint64_t>( state.messagesSent );
+    writer.put<uint64_t>( state.messagesDelivered );
+    writer.put<uint64_t>( state.messagesDropped );
+    writer.put<double>( state.meanDelay );
+    writer.put<double>( state.maxDelay );
+    writer.put<double>( state.lastDeliveryTime );
+
+    writer.put<int64_t>( state.syncTime );
+    writer.put<int64_t>( state.nextEventTime );
+
+    writer.putGenerator( state.generator );
+
+    // Event queue, 16 bytes per event (plus the arrival number for the heap).
+    const EventQueue::Backend backend = state.eventQueue.getBackend();
+    writer.put<int32_t>( backend );
+    writer.put<uint64_t>( state.eventQueue.sequence() );
+    writer.put<uint64_t>( state.eventQueue.size() );
+
+    state.eventQueue.visit(
+        [&writer, backend]( const Event& evt, uint64_t arrival )
+        {
+            writer.put<int64_t>( evt.timeStamp );
+            writer.put<int32_t>( evt.msgId );
+            writer.put<uint16_t>( evt.channel );
+            writer.put<uint16_t>( evt.payload );
+            if ( EventQueue::heap == backend ) writer.put<uint64_t>( arrival );
+        }
     );
+}
+
+bool
+Pipeline_deterministic::deserializeState(
+    StateSerialization::Reader& reader,
+    State& state
+) const {
+    if ( false == reader.getHeader( INSTANTIATION_TOKEN ) ) return false;
 
-    // Insert event into queue.
-    std::pair<EventQueue::iterator ,bool> insertResult = this->eventQueue_.insert( evt );
-    bool validEvent = insertResult.second;
+    int32_t mode = reader.get<int32_t>();
+    if ( ( 0 >= mode ) || ( fatal < mode ) || ( 0 != ( mode & ( mode - 1 ) ) ) ) return false;
 
-    // Delete the event, because it has not been inserted successfully (another event with
-    // the same timestamp alreay exists).
-    if ( false == validEvent )
+    state.mode = static_cast<FMUMode>( mode );
+    state.eventHappenedInternal = ( 0 != reader.get<uint8_t>() );
+
+    state.inClock = ( 0 != reader.get<uint8_t>() );
+    state.outClock = ( 0 != reader.get<uint8_t>() );
+
+    const uint64_t nChannels = reader.get<uint64_t>();
+    if ( nChannels != this->nChannels_ ) return false;
+
+    state.in.resize( nChannels );
+    state.inActive.resize( nChannels );
+    state.out.resize( nChannels );
+    state.outActive.resize( nChannels );
+    for ( size_t c = 0; c < nChannels; ++c )
     {
-        this->logDebug(
-            "veto for event at t = %f", msgReceiveTime
-        );
+        state.in[c] = reader.get<int32_t>();
+        state.inActive[c] = ( 0 != reader.get<uint8_t>() );
+        state.out[c] = reader.get<int32_t>();
+        state.outActive[c] = ( 0 != reader.get<uint8_t>() );
+    }
 
-        delete evt;
-        return false;
+    const uint64_t batchSize = reader.get<uint64_t>();
+    if ( batchSize != this->outBatch_.size() ) return false;
+
+    state.outBatch.resize( batchSize );
+    state.outBatchChannel.resize( batchSize );
+    for ( size_t i = 0; i < batchSize; ++i )
+    {
+        state.outBatch[i] = reader.get<int32_t>();
+        state.outBatchChannel[i] = reader.get<uint16_t>();
+        if ( static_cast<uint64_t>( state.outBatchChannel[i] ) >= nChannels ) return false;
     }
+    state.outCount = reader.get<int32_t>();
+
+    state.messagesSent = reader.get<uint64_t>();
+    state.messagesDelivered = reader.get<uint64_t>();
+    state.messagesDropped = reader.get<uint64_t>();
+    state.meanDelay = reader.get<double>();
+    state.maxDelay = reader.get<double>();
+    state.lastDeliveryTime = reader.get<double>();
+
+    state.syncTime = reader.get<int64_t>();
+    state.nextEventTime = reader.get<int64_t>();
+
+    reader.getGenerator( state.generator );
 
-    if ( firstEvent || ( msgReceiveTime < this->nextEventTime_ ) )
+    // Event queue, restored record by record in the serialized order.
+    const int32_t backend = reader.get<int32_t>();
+    const uint64_t sequence = reader.get<uint64_t>();
+    const uint64_t count = reader.get<uint64_t>();
+
+    if ( ( false == reader.ok() ) || ( false == EventQueue::isValidBackend( backend ) ) ) return false;
+
+    state.eventQueue.restore( static_cast<EventQueue::Backend>( backend ), sequence );
+
+    for ( uint64_t i = 0; i < count; ++i )
+    {
+        TimeStamp timeStamp = reader.get<int64_t>();
+        MessageID msgId = reader.get<int32_t>();
+        Channel channel = reader.get<uint16_t>();
+        Payload payload = reader.get<uint16_t>();
+        uint64_t arrival = ( EventQueue::heap == backend ) ? reader.get<uint64_t>() : 0;
+
+        // Payloads are not part of FMU states.
+        if ( ( false == reader.ok() ) || ( channel >= nChannels ) || ( PayloadPool::none != payload ) ) return false;
+
+        if ( false == state.eventQueue.restoreEvent( Event( timeStamp, msgId, channel, payload ), arrival ) ) return false;
+    }
+
+    return reader.ok() && reader.atEnd();
+}
+
+std::vector<Payload>*
+Pipeline_deterministic::findPayloadVariable( fmi3ValueReference vr )
+{
+    if ( vrInPayload_ == vr ) return &this->inPayload_;
+    if ( vrOutPayload_ == vr ) return &this->outPayload_;
+    if ( vrOutBatchPayload_ == vr ) return &this->outBatchPayload_;
+    return nullptr;
+}
+
+void
+Pipeline_deterministic::addNewEvent(
+    const TimeStamp& msgReceiveTime,
+    const MessageID& msgId,
+    const Channel& channel,
+    const Payload& payload
+) {
+    this->logDebug(
+        logQueue, "add new event at t = %f - id = %d - channel = %d", this->toSeconds( msgReceiveTime ), msgId, channel
+    );
+
+    // Insert event into queue (stored by value, no allocation in steady state). The event
+    // shares the payload with the input variable.
+    this->payloadPool_.addReference( payload );
+    this->eventQueue_.push( Event( msgReceiveTime, msgId, channel, payload ) );
+
+    if ( msgReceiveTime < this->nextEventTime_ )
     {
-        this->currentEvent_ = insertResult.first;
         this->nextEventTime_ = msgReceiveTime;
     }
+}
 
-    return true;
+TimeStamp
+Pipeline_deterministic::calculateDelay()
+{
+    // Empirical distribution (non-negative by construction) or normal distribution (no
+    // negative delays!).
+    double randomValue = this->delayTable_.empty() ?
+        std::max( this->randomMean_ + this->randomStdDev_ * this->generator_(), this->randomMin_ ) :
+        this->delayTable_( this->generator_ );
+
+    // Round down to the permissible time granularity (at least one tick).
+    TickTime::Ticks resolution = std::max<TickTime::Ticks>( 1, this->toTicks( this->eventResolution_ ) );
+    return ( TickTime::fromSecondsFloor( randomValue, this->ticksPerSecond_ ) / resolution ) * resolution;
+}
+
+TickTime::Ticks
+Pipeline_deterministic::toTicks( fmi3Float64 t ) const
+{
+    return TickTime::fromSeconds( t, this->ticksPerSecond_ );
 }
 
 fmi3Float64
-Pipeline_deterministic::calculateDelay()
+Pipeline_deterministic::toSeconds( TickTime::Ticks t ) const
 {
-    // No negative delays!
-    double randomValue= std::max(
-        this->distribution_( this->generator_ ),
-        this->randomMin_
-    );
-    double roundedValue=std::floor(randomValue/eventResolution_)*eventResolution_;
-    return roundedValue;
+    return TickTime::toSeconds( t, this->ticksPerSecond_ );
 }
 
 void
 Pipeline_deterministic::deactivateAllClocks()
 {
-    inClock_ = fmi3ClockInactive;
-    outClock_ = fmi3ClockInactive;
+    this->inClock_ = fmi3ClockInactive;
+    this->outClock_ = fmi3ClockInactive;
+    std::fill( this->outActive_.begin(), this->outActive_.end(), fmi3False );
+}
+
+void
+Pipeline_deterministic::recordSent( TimeStamp delay )
+{
+    const fmi3Float64 seconds = this->toSeconds( delay );
+
+    ++this->messagesSent_;
+    this->meanDelay_ += ( seconds - this->meanDelay_ ) / this->messagesSent_;
+    this->maxDelay_ = std::max( this->maxDelay_, seconds );
+
+    this->queueDepth_ = this->eventQueue_.size();
+    this->messagesInFlight_ = this->messagesSent_ - this->messagesDelivered_ - this->messagesDropped_;
+}
+
+void
+Pipeline_deterministic::recordDelivered()
+{
+    ++this->messagesDelivered_;
+    this->lastDeliveryTime_ = this->toSeconds( this->syncTime_ );
+
+    this->queueDepth_ = this->eventQueue_.size();
+    this->messagesInFlight_ = this->messagesSent_ - this->messagesDelivered_ - this->messagesDropped_;
+}
+
+void
+Pipeline_deterministic::resetStatistics()
+{
+    this->queueDepth_ = 0;
+    this->messagesInFlight_ = 0;
+    this->messagesSent_ = 0;
+    this->messagesDelivered_ = 0;
+    this->messagesDropped_ = 0;
+    this->meanDelay_ = 0.;
+    this->maxDelay_ = 0.;
+    this->lastDeliveryTime_ = 0.;
 }
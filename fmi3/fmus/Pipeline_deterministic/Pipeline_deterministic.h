@@ -7,10 +7,14 @@
 #ifndef Pipeline_deterministic_h
 #define Pipeline_deterministic_h
 
-#include <random>
+#include <vector>
 
 #include "InstanceBase.h"
 #include "DeterministicEventQueue.h"
+#include "EventTrace.h"
+#include "EmpiricalDistribution.h"
+#include "NormalGenerator.h"
+#include "StateSerialization.h"
 
 class Pipeline_deterministic : public InstanceBase {
 
@@ -51,48 +55,62 @@ public:
         fmi3Boolean timeEvent*/
     );
 
+    virtual fmi3Status terminate();
+
     virtual fmi3Status reset();
 
-    virtual fmi3Status getInt32(
-        const fmi3ValueReference valueReferences[],
-        size_t nValueReferences,
-        fmi3Int32 values[],
-        size_t nValues
+    virtual fmi3Status updateDiscreteStates(
+        fmi3Boolean *discreteStatesNeedUpdate,
+        fmi3Boolean *terminateSimulation,
+        fmi3Boolean *nominalsOfContinuousStatesChanged,
+        fmi3Boolean *valuesOfContinuousStatesChanged,
+        fmi3Boolean *nextEventTimeDefined,
+        fmi3Float64 *nextEventTime
     );
 
-    virtual fmi3Status getClock(
+    virtual fmi3Status getBinary(
         const fmi3ValueReference valueReferences[],
         size_t nValueReferences,
-        fmi3Clock values[]
+        size_t sizes[],
+        fmi3Binary values[],
+        size_t nValues
     );
 
-    virtual fmi3Status setFloat64(
+    virtual fmi3Status setBinary(
         const fmi3ValueReference valueReferences[],
         size_t nValueReferences,
-        const fmi3Float64 values[],
+        const size_t sizes[],
+        const fmi3Binary values[],
         size_t nValues
     );
 
-    virtual fmi3Status setInt32(
-        const fmi3ValueReference valueReferences[],
-        size_t nValueReferences,
-        const fmi3Int32 values[],
-        size_t nValues
+    virtual fmi3Status getFMUState(
+        fmi3FMUState* fmuState
     );
 
-    virtual fmi3Status setClock(
-        const fmi3ValueReference valueReferences[],
-        size_t nValueReferences,
-        const fmi3Clock values[]
+    virtual fmi3Status setFMUState(
+        fmi3FMUState fmuState
     );
 
-    virtual fmi3Status updateDiscreteStates(
-        fmi3Boolean *discreteStatesNeedUpdate,
-        fmi3Boolean *terminateSimulation,
-        fmi3Boolean *nominalsOfContinuousStatesChanged,
-        fmi3Boolean *valuesOfContinuousStatesChanged,
-        fmi3Boolean *nextEventTimeDefined,
-        fmi3Float64 *nextEventTime
+    virtual fmi3Status freeFMUState(
+        fmi3FMUState* fmuState
+    );
+
+    virtual fmi3Status serializedFMUStateSize(
+        fmi3FMUState fmuState,
+        size_t* size
+    );
+
+    virtual fmi3Status serializeFMUState(
+        fmi3FMUState fmuState,
+        fmi3Byte serializedState[],
+        size_t size
+    );
+
+    virtual fmi3Status deSerializeFMUState(
+        const fmi3Byte serializedState[],
+        size_t size,
+        fmi3FMUState* fmuState
     );
 
     virtual fmi3Status doStep(
@@ -107,34 +125,121 @@ public:
 
 private:
 
+    // Snapshot of the state of the pipeline (see getFMUState). The event queue shares its
+    // storage with the pipeline's queue (copy-on-write), i.e., taking and restoring a
+    // snapshot does not depend on the number of events in flight.
+    struct State {
+        FMUMode mode;
+        fmi3Boolean eventHappenedInternal;
+        std::vector<fmi3Int32> in;
+        fmi3Clock inClock;
+        std::vector<fmi3Boolean> inActive;
+        std::vector<fmi3Int32> out;
+        fmi3Clock outClock;
+        std::vector<fmi3Boolean> outActive;
+        std::vector<fmi3Int32> outBatch;
+        std::vector<fmi3Int32> outBatchChannel;
+        fmi3Int32 outCount;
+        fmi3UInt64 messagesSent;
+        fmi3UInt64 messagesDelivered;
+        fmi3UInt64 messagesDropped;
+        fmi3Float64 meanDelay;
+        fmi3Float64 maxDelay;
+        fmi3Float64 lastDeliveryTime;
+        TickTime::Ticks syncTime;
+        TickTime::Ticks nextEventTime;
+        DeterministicEventQueue::EventQueue eventQueue;
+        NormalGenerator generator;
+    };
+
+    void saveState( State& state ) const;
+    void restoreState( const State& state );
+
+    // Write a state in the binary format of serialized states (see StateSerialization.h).
+    void serializeState( const State& state, StateSerialization::Writer& writer ) const;
+
+    // Read a serialized state, returns false if the data is invalid for this instance.
+    bool deserializeState( StateSerialization::Reader& reader, State& state ) const;
+
 	// This function adds new events to the event queue.
-	bool addNewEvent( 
+	void addNewEvent( 
         const DeterministicEventQueue::TimeStamp& msgReceiveTime,
         const DeterministicEventQueue::MessageID& msgId,
-        const DeterministicEventQueue::Receiver& receiver,
-        const DeterministicEventQueue::ReceiverClock& clock
+        const DeterministicEventQueue::Channel& channel,
+        const DeterministicEventQueue::Payload& payload
     );
 
-    fmi3Float64 calculateDelay();
+    // Payload variable with the given value reference (nullptr if there is none).
+    std::vector<DeterministicEventQueue::Payload>* findPayloadVariable( fmi3ValueReference vr );
+
+    DeterministicEventQueue::TimeStamp calculateDelay();
+
+    // Conversion between FMI time (seconds) and internal time (ticks).
+    TickTime::Ticks toTicks( fmi3Float64 t ) const;
+    fmi3Float64 toSeconds( TickTime::Ticks t ) const;
 
     void deactivateAllClocks();
 
-    // Input variable "in" (value reference 1001).
-    fmi3Int32 in_;
+    // Update the statistics when a message has been sent or delivered (constant time).
+    void recordSent( DeterministicEventQueue::TimeStamp delay );
+    void recordDelivered();
+    void resetStatistics();
+
+    // Input array variable "in" (value reference 1001), one message per channel.
+    std::vector<fmi3Int32> in_;
     static const fmi3ValueReference vrIn_ = 1001;
 
-    // Input clock "in_clock" (value reference 1002).
+    // Input clock "inClock" (value reference 1002), shared by all channels.
     fmi3Clock inClock_;
     static const fmi3ValueReference vrInClock_ = 1002;
 
-    // Output variable "out" (value reference 2001).
-    fmi3Int32 out_;
+    // Input binary array variable "inPayload" (value reference 1003), payload of the message
+    // of each channel (handles into the payload pool).
+    std::vector<DeterministicEventQueue::Payload> inPayload_;
+    static const fmi3ValueReference vrInPayload_ = 1003;
+
+    // Input boolean array variable "inActive" (value reference 1004), channels that carry a
+    // message when the input clock ticks.
+    std::vector<fmi3Boolean> inActive_;
+    static const fmi3ValueReference vrInActive_ = 1004;
+
+    // Output array variable "out" (value reference 2001), one message per channel.
+    std::vector<fmi3Int32> out_;
     static const fmi3ValueReference vrOut_ = 2001;
 
-    // Output clock "out_clock" (value reference 2002).
+    // Output clock "outClock" (value reference 2002), shared by all channels.
     fmi3Clock outClock_;
     static const fmi3ValueReference vrOutClock_ = 2002;
 
+    // Output array variable "outBatch" (value reference 2003), holds all messages delivered
+    // in the current event (dimension given by parameter "batchSize").
+    std::vector<fmi3Int32> outBatch_;
+    static const fmi3ValueReference vrOutBatch_ = 2003;
+
+    // Output variable "outCount" (value reference 2004), number of valid entries of "outBatch".
+    fmi3Int32 outCount_;
+    static const fmi3ValueReference vrOutCount_ = 2004;
+
+    // Output binary array variable "outPayload" (value reference 2005), payload of the
+    // delivered message of each channel (handles into the payload pool).
+    std::vector<DeterministicEventQueue::Payload> outPayload_;
+    static const fmi3ValueReference vrOutPayload_ = 2005;
+
+    // Output binary array variable "outBatchPayload" (value reference 2006), payloads of the
+    // messages in "outBatch" (handles into the payload pool).
+    std::vector<DeterministicEventQueue::Payload> outBatchPayload_;
+    static const fmi3ValueReference vrOutBatchPayload_ = 2006;
+
+    // Output array variable "outBatchChannel" (value reference 2007), channels of the messages
+    // in "outBatch".
+    std::vector<fmi3Int32> outBatchChannel_;
+    static const fmi3ValueReference vrOutBatchChannel_ = 2007;
+
+    // Output boolean array variable "outActive" (value reference 2008), channels that carry a
+    // delivered message when the output clock ticks.
+    std::vector<fmi3Boolean> outActive_;
+    static const fmi3ValueReference vrOutActive_ = 2008;
+
     // Permissible time granularity of the events generated, for importers with minimum time steps like mosaik3 (parameter, value reference 3000).
     fmi3Float64 eventResolution_;
     static const fmi3ValueReference vrEventResolution_ = 3000;
@@ -155,23 +260,104 @@ private:
     fmi3Float64 randomMin_;
     static const fmi3ValueReference vrRandomMin_ = 3004;
 
-    // Current internal synchronization point.
-    fmi3Float64 syncTime_;
+    // Resolution of the internal time base in ticks per second (parameter, value reference 3005).
+    fmi3Int32 ticksPerSecond_;
+    static const fmi3ValueReference vrTicksPerSecond_ = 3005;
+
+    // Event queue backend, 0: heap, 1: timing wheel (parameter, value reference 3006).
+    fmi3Int32 eventScheduler_;
+    static const fmi3ValueReference vrEventScheduler_ = 3006;
+
+    // Maximum number of messages delivered per event (structural parameter, value reference 3007).
+    fmi3UInt64 batchSize_;
+    static const fmi3ValueReference vrBatchSize_ = 3007;
+
+    // Number of channels, i.e., dimension of "in", "in_clock", "out" and "out_clock" (structural parameter, value reference 3008).
+    fmi3UInt64 nChannels_;
+    static const fmi3ValueReference vrNChannels_ = 3008;
 
-	// Time of the next scheduled event.
-	fmi3Float64 nextEventTime_;
+    // Number of payloads that can be held at the same time (structural parameter, value reference 3009).
+    fmi3UInt64 payloadPoolSize_;
+    static const fmi3ValueReference vrPayloadPoolSize_ = 3009;
 
-	// Precision for detecting events.
+    // Maximum size of a payload in bytes (structural parameter, value reference 3010).
+    fmi3UInt64 maxPayloadSize_;
+    static const fmi3ValueReference vrMaxPayloadSize_ = 3010;
+
+    // Number of records of the message trace, 0: no trace (parameter, value reference 3011).
+    fmi3UInt64 traceCapacity_;
+    static const fmi3ValueReference vrTraceCapacity_ = 3011;
+
+    // File of an empirical delay distribution in the resource directory, empty: normal
+    // distribution (parameter, value reference 3012, see EmpiricalDistribution.h).
+    std::string delayDistribution_;
+    static const fmi3ValueReference vrDelayDistribution_ = 3012;
+
+    // Statistics of the pipeline (outputs, value references 4001 to 4008), updated with every
+    // message sent or delivered.
+
+    // Number of events in the event queue (value reference 4001).
+    fmi3UInt64 queueDepth_;
+    static const fmi3ValueReference vrQueueDepth_ = 4001;
+
+    // Number of messages sent and neither delivered nor dropped yet (value reference 4002).
+    fmi3UInt64 messagesInFlight_;
+    static const fmi3ValueReference vrMessagesInFlight_ = 4002;
+
+    // Total number of messages sent, delivered and dropped (value references 4003, 4004 and 4005).
+    fmi3UInt64 messagesSent_;
+    static const fmi3ValueReference vrMessagesSent_ = 4003;
+    fmi3UInt64 messagesDelivered_;
+    static const fmi3ValueReference vrMessagesDelivered_ = 4004;
+    fmi3UInt64 messagesDropped_;
+    static const fmi3ValueReference vrMessagesDropped_ = 4005;
+
+    // Mean and maximum of the sampled delays in seconds (value references 4006 and 4007).
+    fmi3Float64 meanDelay_;
+    static const fmi3ValueReference vrMeanDelay_ = 4006;
+    fmi3Float64 maxDelay_;
+    static const fmi3ValueReference vrMaxDelay_ = 4007;
+
+    // Time of the last delivery in seconds (value reference 4008).
+    fmi3Float64 lastDeliveryTime_;
+    static const fmi3ValueReference vrLastDeliveryTime_ = 4008;
+
+    // Simulation start time (seconds).
+    fmi3Float64 startTime_;
+
+    // Current internal synchronization point (ticks).
+    TickTime::Ticks syncTime_;
+
+	// Time of the next scheduled event (ticks).
+	TickTime::Ticks nextEventTime_;
+
+	// Precision for matching the importer's communication points (seconds and ticks).
 	fmi3Float64 tolerance_;
+	TickTime::Ticks toleranceTicks_;
 
 	// Event queue.
 	DeterministicEventQueue::EventQueue eventQueue_;
-	DeterministicEventQueue::EventQueue::iterator currentEvent_;
 
-    // Random generator (Gaussian);
-    std::default_random_engine generator_;
-    std::normal_distribution<fmi3Float64> distribution_;
+	// Payloads of the messages (held by "inPayload", the events in flight, "outPayload" and
+	// "outBatchPayload").
+	PayloadPool payloadPool_;
+
+	// Trace of received and delivered messages (see EventTrace.h).
+	EventTrace trace_;
+
+    // Random generator (standard normal samples, reproducible on all platforms).
+    NormalGenerator generator_;
+
+    // Empirical delay distribution (alias table), loaded in exitInitializationMode.
+    EmpiricalDistribution delayTable_;
 
+    // Variables of the FMU by type, sorted by value reference (see VariableTable.h).
+    static const VariableDescription<Pipeline_deterministic, fmi3Int32> int32Variables_[8];
+    static const VariableDescription<Pipeline_deterministic, fmi3Float64> float64Variables_[7];
+    static const VariableDescription<Pipeline_deterministic, fmi3UInt64> uInt64Variables_[10];
+    static const VariableDescription<Pipeline_deterministic, fmi3Boolean> booleanVariables_[2];
+    static const VariableDescription<Pipeline_deterministic, fmi3Clock> clockVariables_[2];
+    static const VariableDescription<Pipeline_deterministic, std::string> stringVariables_[1];
 };
 
 #endif // Pipeline_deterministic_h
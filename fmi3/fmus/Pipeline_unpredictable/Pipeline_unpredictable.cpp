@@ -5,6 +5,9 @@
  **************************************************************************/
 
 #include "Pipeline_unpredictable.h"
+#ifdef UNPREDICTABLE_EVENT_STACK_SPSC
+#include "Pipeline_unpredictableProducer.h"
+#endif
 
 #include <limits>
 #include <algorithm>
@@ -14,6 +17,17 @@
 
 using namespace UnpredictableEventStack;
 
+constexpr VariableDescription<Pipeline_unpredictable, fmi3Int32> Pipeline_unpredictable::int32Variables_[] = {
+    scalarVariable( vrIn_, &Pipeline_unpredictable::in_, inputVariable ),
+    scalarVariable( vrOut_, &Pipeline_unpredictable::out_, outputVariable ),
+    scalarVariable( vrRandomSeed_, &Pipeline_unpredictable::randomSeed_, parameterVariable )
+};
+
+constexpr VariableDescription<Pipeline_unpredictable, fmi3Clock> Pipeline_unpredictable::clockVariables_[] = {
+    scalarVariable( vrInClock_, &Pipeline_unpredictable::inClock_, inputVariable ),
+    scalarVariable( vrOutClock_, &Pipeline_unpredictable::outClock_, outputVariable )
+};
+
 Pipeline_unpredictable::Pipeline_unpredictable(
     fmi3String instanceName,
     fmi3String instantiationToken,
@@ -25,8 +39,8 @@ Pipeline_unpredictable::Pipeline_unpredictable(
     const fmi3ValueReference requiredIntermediateVariables[],
     size_t nRequiredIntermediateVariables,
     fmi3InstanceEnvironment instanceEnvironment,
-    fmi3CallbackLogMessage logMessage,
-    fmi3CallbackIntermediateUpdate intermediateUpdate
+    fmi3LogMessageCallback logMessage,
+    fmi3IntermediateUpdateCallback intermediateUpdate
 ) :
     InstanceBase(
         instanceName,
@@ -45,7 +59,8 @@ Pipeline_unpredictable::Pipeline_unpredictable(
     in_( 0 ),
     out_( 0 ),
     randomSeed_( 1 ),
-    tolerance_( 1e-9 )
+    tolerance_( 1e-9 ),
+    eventHappenedInternal_( fmi3False )
 {
     if ( fmi3False == this->getEventModeUsed() )
     {
@@ -62,8 +77,18 @@ Pipeline_unpredictable::Pipeline_unpredictable(
         throw std::runtime_error( "Wrong GUID (instantiation token)." );
     }
 
+    // Channel 0: output variable "out" and output clock "out_clock".
+    OutputChannel out = { &this->out_, &this->outClock_ };
+    this->outputChannels_.push_back( out );
+
+    // Bind the variables of the FMU (value references must match FMI3.xml).
+    static_assert( hasIncreasingValueReferences( int32Variables_ ), "int32 variables must be sorted by value reference" );
+    this->int32Table_.bind( this, int32Variables_ );
+    static_assert( hasIncreasingValueReferences( clockVariables_ ), "clock variables must be sorted by value reference" );
+    this->clockTable_.bind( this, clockVariables_ );
+
     this->logDebug(
-        "successfully initialized class %s", "Pipeline_unpredictable"
+        logInstance, "successfully initialized class %s", "Pipeline_unpredictable"
     );
 }
 
@@ -111,18 +136,20 @@ Pipeline_unpredictable::exitInitializationMode()
 
 fmi3Status
 Pipeline_unpredictable::enterEventMode(
-    fmi3Boolean stepEvent,
+    /*fmi3Boolean stepEvent,
     fmi3Boolean stateEvent,
     const fmi3Int32 rootsFound[],
     size_t nEventIndicators,
-    fmi3Boolean timeEvent
+    fmi3Boolean timeEvent*/
 ) {
     this->setMode( eventMode );
 
-    // This is a time event that was previously signaled by function doStep.
+    // This is an internal event that was previously signaled by function doStep.
     // This means that a new message is available to be received by the importer.
-    if ( fmi3True == timeEvent )
+    if ( fmi3True == this->eventHappenedInternal_ )
     {
+        this->eventHappenedInternal_ = fmi3False;
+
         if ( true == this->applyCurrentEvent() )
         {
             this->removeCurrentEvent();
@@ -138,185 +165,30 @@ Pipeline_unpredictable::enterEventMode(
 }
 
 fmi3Status
-Pipeline_unpredictable::reset()
+Pipeline_unpredictable::terminate()
 {
-    while ( false == this->eventStack_.empty() )
-    {
-        delete this->eventStack_.front();
-        this->eventStack_.pop();
-    }
-
-    return fmi3OK;
-}
-
-fmi3Status
-Pipeline_unpredictable::getInt32(
-    const fmi3ValueReference valueReferences[],
-    size_t nValueReferences,
-    fmi3Int32 values[],
-    size_t nValues
-) {
-    if ( nValueReferences != nValues ) {
-        this->logError(
-            "%s %s",
-            "This FMU only supports scalar variables.",
-            "The number of value references and values must match!"
-        );
-        return fmi3Error;
-    }
-
-    fmi3Status status = fmi3OK;
-    const fmi3ValueReference* vr;
-    fmi3Int32* v;
-
-    for (
-        vr = valueReferences, v = values;
-        vr != valueReferences + nValues, v != values + nValues;
-        ++vr, ++v
-    ) {
-        switch ( *vr ) {
-            case this->vrOut_:
-                *v = this->out_;
-                this->logDebug( "%d => get %d", *vr, this->out_ );
-                break;
-            default:
-                this->logError( "Invalid value reference: %d", *vr );
-                status = fmi3Error;
-        }
-    }
-
-    return status;
-}
-
-fmi3Status
-Pipeline_unpredictable::getClock(
-    const fmi3ValueReference valueReferences[],
-    size_t nValueReferences,
-    fmi3Clock values[],
-    size_t nValues
-) {
-    if ( nValueReferences != nValues ) {
-        this->logError(
-            "%s %s",
-            "This FMU only supports scalar variables.",
-            "The number of value references and values must match!"
-        );
-        return fmi3Error;
-    }
-
-    fmi3Status status = fmi3OK;
-    const fmi3ValueReference* vr;
-    fmi3Clock* v;
-
-    for (
-        vr = valueReferences, v = values;
-        vr != valueReferences + nValues, v != values + nValues;
-        ++vr, ++v
-    ) {
-        switch ( *vr ) {
-            case this->vrOutClock_:
-                *v = this->outClock_;
-                this->logDebug( "%d => get clock %d", *vr, this->outClock_ );
-                break;
-            default:
-                this->logError( "Invalid value reference: %d", *vr );
-                status = fmi3Error;
-        }
-    }
-
-    return status;
-}
-
-fmi3Status
-Pipeline_unpredictable::setInt32(
-    const fmi3ValueReference valueReferences[],
-    size_t nValueReferences,
-    const fmi3Int32 values[],
-    size_t nValues
-) {
-    if ( nValueReferences != nValues ) {
-        this->logError(
-            "%s %s",
-            "This FMU only supports scalar variables.",
-            "The number of value references and values must match!"
-        );
-        return fmi3Error;
-    }
-
-    fmi3Status status = fmi3OK;
-    const fmi3ValueReference* vr;
-    const fmi3Int32* v;
-
-    for (
-        vr = valueReferences, v = values;
-        vr != valueReferences + nValues, v != values + nValues;
-        ++vr, ++v
-    ) {
-        switch ( *vr ) {
-            case this->vrIn_:
-                this->in_ = *v;
-                break;
-            case this->vrRandomSeed_:
-                this->randomSeed_ = *v;
-                break;
-            default:
-                this->logError( "Invalid value reference: %d", *vr );
-                status = fmi3Error;
-        }
-
-        this->logDebug( "Value reference %d => set to: %d (fmi3Int32)", *vr, *v );
-    }
+    this->logDebug(
+        logQueue, "event queue high-water mark: %zu events", this->eventStack_.highWaterMark()
+    );
 
-    return status;
+    return InstanceBase::terminate();
 }
 
 fmi3Status
-Pipeline_unpredictable::setClock(
-    const fmi3ValueReference valueReferences[],
-    size_t nValueReferences,
-    const fmi3Clock values[],
-    size_t nValues
-) {
-    if ( nValueReferences != nValues ) {
-        this->logError(
-            "%s %s",
-            "This FMU only supports scalar variables.",
-            "The number of value references and values must match!"
-        );
-        return fmi3Error;
-    }
+Pipeline_unpredictable::reset()
+{
+    this->logDebug(
+        logQueue, "event queue high-water mark: %zu events", this->eventStack_.highWaterMark()
+    );
 
-    fmi3Status status = fmi3OK;
-    const fmi3ValueReference* vr;
-    const fmi3Clock* v;
-
-    for (
-        vr = valueReferences, v = values;
-        vr != valueReferences + nValues, v != values + nValues;
-        ++vr, ++v
-    ) {
-        switch ( *vr ) {
-            case this->vrInClock_:
-                if ( fmi3ClockInactive == *v )
-                {
-                    this->logError(
-                        "clocks may not be deactivated by the importer"
-                    );
-                    return fmi3Error;
-                }
-                this->inClock_ = *v;
-                break;
-            default:
-                this->logError( "Invalid value reference: %d", *vr );
-                status = fmi3Error;
-        }
+    this->eventStack_.release();
+    this->eventHappenedInternal_ = fmi3False;
 
-        this->logDebug(
-            "%d => set clock %d", *vr, *v
-        );
-    }
+#ifdef UNPREDICTABLE_EVENT_STACK_SPSC
+    this->producerStack_.release();
+#endif
 
-    return status;
+    return fmi3OK;
 }
 
 fmi3Status
@@ -333,8 +205,7 @@ Pipeline_unpredictable::updateDiscreteStates(
     {
         this->addNewEvent(
             this->in_,
-            &this->out_,
-            &this->outClock_
+            0
         );
     }
 
@@ -376,11 +247,15 @@ Pipeline_unpredictable::doStep(
     // Update internal synchronization time to new requested communication point.
     this->syncTime_ = currentCommunicationPoint + communicationStepSize;
     this->logDebug(
-        "Attempt to step from %f to %f",
+        logStep, "Attempt to step from %f to %f",
         currentCommunicationPoint,
         this->syncTime_
     );
 
+#ifdef UNPREDICTABLE_EVENT_STACK_SPSC
+    this->takeProducerEvents();
+#endif
+
     // We have at least one event that can be applied.
     if ( false == this->eventStack_.empty() ) 
     {
@@ -389,11 +264,12 @@ Pipeline_unpredictable::doStep(
         fmi3Float64 nextEventTime = currentCommunicationPoint + fraction * communicationStepSize;
 
         this->logDebug(
-            "An internal event occured at time = %f",
+            logStep, "An internal event occured at time = %f",
             nextEventTime
         );
 
         this->syncTime_ = nextEventTime;
+        this->eventHappenedInternal_ = fmi3True;
 
         *eventEncountered = fmi3True;
         *earlyReturn = fmi3True;
@@ -414,31 +290,63 @@ Pipeline_unpredictable::doStep(
 void
 Pipeline_unpredictable::addNewEvent(
     const MessageID& msgId,
-    const Receiver& receiver,
-    const ReceiverClock& clock
+    const Channel& channel
 ) {
-    // Create new event.
-    Event* evt = new Event(
-        msgId,
-        receiver,
-        clock
-    );
-
-    this->eventStack_.push( evt );
+    if ( false == this->eventStack_.push( Event( msgId, channel ) ) )
+    {
+        this->logError(
+            "event stack full, dropped event with id = %d", msgId
+        );
+        return;
+    }
 
     this->logDebug(
-        "add new event with id = %d", msgId
+        logQueue, "add new event with id = %d", msgId
     );
 }
 
+#ifdef UNPREDICTABLE_EVENT_STACK_SPSC
+bool
+Pipeline_unpredictable::pushFromProducer(
+    MessageID msgId
+) {
+    // Logging is left to the importer's thread (see takeProducerEvents).
+    return this->producerStack_.push( Event( msgId, 0 ) );
+}
+
+void
+Pipeline_unpredictable::takeProducerEvents()
+{
+    while ( false == this->producerStack_.empty() )
+    {
+        this->addNewEvent( this->producerStack_.front().msgId, this->producerStack_.front().channel );
+        this->producerStack_.pop();
+    }
+}
+
+fmi3Status
+Pipeline_unpredictable_pushFromProducer(
+    fmi3Instance instance,
+    fmi3Int32 msgId
+) {
+    // Called concurrently with the importer's calls, hence there is no mode check (the mode
+    // belongs to the importer's thread).
+    if ( nullptr == instance ) return fmi3Error;
+
+    Pipeline_unpredictable* impl = static_cast<Pipeline_unpredictable*>( static_cast<InstanceBase*>( instance ) );
+    return impl->pushFromProducer( msgId ) ? fmi3OK : fmi3Discard;
+}
+#endif
+
 bool
 Pipeline_unpredictable::applyCurrentEvent()
 {
     if ( true == this->eventStack_.empty() ) return false;
 
-    Event* evt = this->eventStack_.front();
-    *( evt->receiver ) = evt->msgId;
-    *( evt->clock ) = fmi3ClockActive;
+    const Event& evt = this->eventStack_.front();
+    const OutputChannel& output = this->outputChannels_[ evt.channel ];
+    *( output.receiver ) = evt.msgId;
+    *( output.clock ) = fmi3ClockActive;
 
     return true;
 }
@@ -448,7 +356,6 @@ Pipeline_unpredictable::removeCurrentEvent()
 {
     if ( true == this->eventStack_.empty() ) return false;
 
-    delete this->eventStack_.front();
     this->eventStack_.pop();
 
     return true;
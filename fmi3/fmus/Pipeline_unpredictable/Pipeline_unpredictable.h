@@ -8,6 +8,7 @@
 #define Pipeline_unpredictable_h
 
 #include <random>
+#include <vector>
 
 #include "InstanceBase.h"
 #include "UnpredictableEventStack.h"
@@ -27,8 +28,8 @@ public:
         const fmi3ValueReference requiredIntermediateVariables[],
         size_t nRequiredIntermediateVariables,
         fmi3InstanceEnvironment instanceEnvironment,
-        fmi3CallbackLogMessage logMessage,
-        fmi3CallbackIntermediateUpdate intermediateUpdate
+        fmi3LogMessageCallback logMessage,
+        fmi3IntermediateUpdateCallback intermediateUpdate
     );
 
     virtual fmi3Status enterInitializationMode(
@@ -42,42 +43,16 @@ public:
     virtual fmi3Status exitInitializationMode();
 
     virtual fmi3Status enterEventMode(
-        fmi3Boolean stepEvent,
+        /*fmi3Boolean stepEvent,
         fmi3Boolean stateEvent,
         const fmi3Int32 rootsFound[],
         size_t nEventIndicators,
-        fmi3Boolean timeEvent
+        fmi3Boolean timeEvent*/
     );
 
-    virtual fmi3Status reset();
-
-    virtual fmi3Status getInt32(
-        const fmi3ValueReference valueReferences[],
-        size_t nValueReferences,
-        fmi3Int32 values[],
-        size_t nValues
-    );
-
-    virtual fmi3Status getClock(
-        const fmi3ValueReference valueReferences[],
-        size_t nValueReferences,
-        fmi3Clock values[],
-        size_t nValues
-    );
-
-    virtual fmi3Status setInt32(
-        const fmi3ValueReference valueReferences[],
-        size_t nValueReferences,
-        const fmi3Int32 values[],
-        size_t nValues
-    );
+    virtual fmi3Status terminate();
 
-    virtual fmi3Status setClock(
-        const fmi3ValueReference valueReferences[],
-        size_t nValueReferences,
-        const fmi3Clock values[],
-        size_t nValues
-    );
+    virtual fmi3Status reset();
 
     virtual fmi3Status updateDiscreteStates(
         fmi3Boolean *discreteStatesNeedUpdate,
@@ -98,15 +73,29 @@ public:
         fmi3Float64* lastSuccessfulTime
     );
 
+#ifdef UNPREDICTABLE_EVENT_STACK_SPSC
+    // Add a message for output channel 0 from a producer thread (exported to the importer as
+    // Pipeline_unpredictable_pushFromProducer, see Pipeline_unpredictableProducer.h), while
+    // the importer's thread steps the FMU. Only a single producer thread may call this
+    // function, and it must not be called during fmi3Reset or after fmi3FreeInstance. The
+    // message is delivered after it has been taken over by the next call of doStep. Returns
+    // false if the producer stack is full.
+    bool pushFromProducer( UnpredictableEventStack::MessageID msgId );
+#endif
+
 private:
 
 	// This function adds new events to the event queue.
 	void addNewEvent( 
         const UnpredictableEventStack::MessageID& msgId,
-        const UnpredictableEventStack::Receiver& receiver,
-        const UnpredictableEventStack::ReceiverClock& clock
+        const UnpredictableEventStack::Channel& channel
     );
 
+#ifdef UNPREDICTABLE_EVENT_STACK_SPSC
+    // Move the messages of the producer thread to the event queue (importer's thread only).
+    void takeProducerEvents();
+#endif
+
     bool applyCurrentEvent();
 
     bool removeCurrentEvent();
@@ -129,6 +118,9 @@ private:
     fmi3Clock outClock_;
     static const fmi3ValueReference vrOutClock_ = 2002;
 
+    // Output channels, indexed by the channel of an event (channel 0: "out" and "out_clock").
+    std::vector<UnpredictableEventStack::OutputChannel> outputChannels_;
+
 	// Random number generator seed (parameter, value reference 3001).
 	fmi3Int32 randomSeed_;
     static const fmi3ValueReference vrRandomSeed_ = 3001;
@@ -139,12 +131,25 @@ private:
 	// Precision for detecting events.
 	fmi3Float64 tolerance_;
 
+	// An internal event has been signaled by doStep, the next message is delivered in
+	// event mode.
+	fmi3Boolean eventHappenedInternal_;
+
 	// Event queue.
 	UnpredictableEventStack::EventStack eventStack_;
 
+#ifdef UNPREDICTABLE_EVENT_STACK_SPSC
+	// Messages added by the producer thread, not yet taken over by the event queue.
+	UnpredictableEventStack::ProducerStack producerStack_;
+#endif
+
     // Random generator (Gaussian);
     std::default_random_engine generator_;
     std::uniform_real_distribution<fmi3Float64> distribution_;
+
+    // Variables of the FMU by type, sorted by value reference (see VariableTable.h).
+    static const VariableDescription<Pipeline_unpredictable, fmi3Int32> int32Variables_[3];
+    static const VariableDescription<Pipeline_unpredictable, fmi3Clock> clockVariables_[2];
 };
 
 #endif // Pipeline_unpredictable_h
@@ -0,0 +1,38 @@
+/**************************************************************************
+ * Copyright (c) ERIGrid 2.0 (H2020 Programme Grant Agreement No. 870620) *
+ * All rights reserved.                                                   *
+ * See file LICENSE in the project root for license information.          *
+ **************************************************************************/
+
+#ifndef Pipeline_unpredictableProducer_h
+#define Pipeline_unpredictableProducer_h
+
+/**
+ * Producer entry point of Pipeline_unpredictable, in addition to the FMI functions. It is
+ * only exported if the FMU is built with the lock-free producer stack (CMake option
+ * UNPREDICTABLE_EVENT_STACK_SPSC), importers look it up like the FMI functions, e.g., with
+ * dlsym( library, "Pipeline_unpredictable_pushFromProducer" ).
+ */
+
+#include "fmi3Functions.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Add a message for the output of the instance from a producer thread, while the importer's
+ * thread steps the instance. Only a single producer thread per instance may call this
+ * function, and not during fmi3Reset or after fmi3FreeInstance. The message is delivered in
+ * the order of the calls, after it has been taken over by the next call of fmi3DoStep.
+ * Returns fmi3Discard (and drops the message) if the producer stack is full.
+ */
+typedef fmi3Status Pipeline_unpredictable_pushFromProducerTYPE( fmi3Instance instance, fmi3Int32 msgId );
+
+FMI3_Export Pipeline_unpredictable_pushFromProducerTYPE Pipeline_unpredictable_pushFromProducer;
+
+#ifdef __cplusplus
+}  /* end of extern "C" { */
+#endif
+
+#endif // Pipeline_unpredictableProducer_h
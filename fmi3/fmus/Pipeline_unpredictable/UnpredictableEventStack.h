@@ -7,34 +7,48 @@
 #ifndef UnpredictableEventStack_h
 #define UnpredictableEventStack_h
 
-#include <queue>
+#include "EventRingBuffer.h"
 
 namespace UnpredictableEventStack
 {
 	typedef fmi3Int32 MessageID;
 	typedef fmi3Int32* Receiver;
 	typedef fmi3Clock* ReceiverClock;
+	typedef fmi3UInt16 Channel;
+
+	// An output channel is an output variable and its associated output clock.
+	struct OutputChannel {
+		Receiver receiver;
+		ReceiverClock clock;
+	};
 
 	struct Event {
 
 		MessageID msgId; // Each event is associated with a message ID.
-		Receiver receiver; // Each message ID is associated to an output variable.
-		ReceiverClock clock; // Each output variable is associated to an output clock.
+		Channel channel; // Each event is associated with an output channel.
+
+		// Default constructor (required for preallocated storage).
+		Event() : msgId( 0 ), channel( 0 ) {}
 
 		// Struct constructor.
 		Event(
             MessageID m,
-            Receiver r,
-            ReceiverClock c
+            Channel c
         ) :
             msgId( m ),
-            receiver( r ),
-            clock( c )
+            channel( c )
         {}
 	};
 
-	// This is the definition of the event queue.
-	typedef std::queue<Event*> EventStack;
+	// This is the definition of the event queue. Events are stored by value in a ring
+	// buffer, accessed by the importer's thread only.
+	typedef EventRingBuffer<Event> EventStack;
+
+	// Events added from a separate producer thread (see Pipeline_unpredictable::pushFromProducer),
+	// lock-free with a fixed capacity. Enabled by the CMake option UNPREDICTABLE_EVENT_STACK_SPSC.
+#ifdef UNPREDICTABLE_EVENT_STACK_SPSC
+	typedef SpscEventRingBuffer<Event> ProducerStack;
+#endif
 }
 
 #endif // UnpredictableEventStack_h
@@ -0,0 +1,119 @@
+/**************************************************************************
+ * Copyright (c) ERIGrid 2.0 (H2020 Programme Grant Agreement No. 870620) *
+ * All rights reserved.                                                   *
+ * See file LICENSE in the project root for license information.          *
+ **************************************************************************/
+
+#ifndef AsyncLogger_h
+#define AsyncLogger_h
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "fmi3FunctionTypes.h"
+#include "EventRingBuffer.h"
+
+// Asynchronous logging back end of an FMU instance.
+//
+// For debug messages, the calling thread only formats a message into a fixed-size record
+// and appends it to a bounded lock-free ring buffer. A background thread drains the buffer
+// and passes the messages to the importer's logger callback or, if the importer did not
+// provide one, writes them to a file (stdout by default). Hence, the callback is called
+// from the background thread. The background thread runs for the lifetime of the logger,
+// it waits on a condition variable while the buffer is empty and is only notified if it
+// is waiting.
+//
+// Warnings and errors are passed to the importer synchronously, on the calling thread,
+// after all pending messages. Hence, the importer has received them when the FMI function
+// that reports them returns, in their original order. Messages are only written while
+// holding a mutex, so the callback is never called concurrently.
+//
+// If the buffer is full, the message is dropped and counted, the number of dropped
+// messages is reported with the next messages written. flush() writes all pending
+// messages, the destructor stops the background thread and writes the remaining ones.
+class AsyncLogger {
+
+public:
+
+    // Number of records in the ring buffer.
+    static const size_t capacity = 1024;
+
+    // Maximum length of a message, including the terminating null (longer messages are truncated).
+    static const size_t maxMessageLength = 240;
+
+    AsyncLogger(
+        fmi3LogMessageCallback callback,
+        fmi3InstanceEnvironment instanceEnvironment,
+        const std::string& instanceName,
+        FILE* file = stdout
+    );
+
+    ~AsyncLogger();
+
+    AsyncLogger( const AsyncLogger& ) = delete;
+    AsyncLogger& operator=( const AsyncLogger& ) = delete;
+
+    // Append a message, or write it immediately if its status is fmi3Warning or worse. The
+    // category must be a string literal (only the pointer is stored).
+    void log(
+        fmi3Status status,
+        const char* category,
+        const char* message,
+        va_list args
+    );
+
+    // Write all pending messages.
+    void flush();
+
+    // Number of messages dropped because the ring buffer was full.
+    uint64_t droppedMessages() const { return this->dropped_.load( std::memory_order_relaxed ); }
+
+private:
+
+    struct Record {
+        fmi3Status status;
+        const char* category;
+        char message[maxMessageLength];
+    };
+
+    // Background thread: drain the buffer until stopped.
+    void run();
+
+    // Write all pending messages (with mutex_ held).
+    void drain();
+
+    void write( fmi3Status status, const char* category, const char* message );
+
+    const fmi3LogMessageCallback callback_;
+    const fmi3InstanceEnvironment instanceEnvironment_;
+    const std::string instanceName_;
+    FILE* const file_;
+
+    std::unique_ptr< SpscEventRingBuffer<Record> > buffer_;
+
+    std::atomic<uint64_t> dropped_;
+
+    // Serializes writing the messages, i.e., draining the buffer and calling the callback.
+    std::mutex mutex_;
+    std::condition_variable wakeUp_;
+
+    // The background thread is waiting (or about to wait) for wakeUp_.
+    std::atomic<bool> waiting_;
+
+    // Number of dropped messages already reported (with mutex_ held).
+    uint64_t reported_;
+
+    // The background thread has to stop (with mutex_ held).
+    bool stopping_;
+
+    std::thread thread_;
+};
+
+#endif // AsyncLogger_h
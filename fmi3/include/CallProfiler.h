@@ -0,0 +1,140 @@
+/**************************************************************************
+ * Copyright (c) ERIGrid 2.0 (H2020 Programme Grant Agreement No. 870620) *
+ * All rights reserved.                                                   *
+ * See file LICENSE in the project root for license information.          *
+ **************************************************************************/
+
+#ifndef CallProfiler_h
+#define CallProfiler_h
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <x86intrin.h>
+#elif defined( _M_X64 ) || defined( _M_IX86 )
+#include <intrin.h>
+#endif
+
+// Latency histogram with logarithmic buckets (HDR style). Values below 16 are counted
+// exactly, larger values in 16 linear sub-buckets per power of two, i.e., with a relative
+// error below 1/16. The memory footprint is fixed (no allocation when recording).
+class LatencyHistogram {
+
+public:
+
+    static const unsigned subBucketBits = 4;
+    static const size_t subBuckets = size_t( 1 ) << subBucketBits;
+    static const size_t buckets = ( 64 - subBucketBits + 1 ) * subBuckets;
+
+    LatencyHistogram() : counts_( buckets, 0 ), count_( 0 ), total_( 0 ), min_( UINT64_MAX ), max_( 0 ) {}
+
+    void record( uint64_t value )
+    {
+        ++this->counts_[ bucketIndex( value ) ];
+        ++this->count_;
+        this->total_ += value;
+        if ( value < this->min_ ) this->min_ = value;
+        if ( value > this->max_ ) this->max_ = value;
+    }
+
+    uint64_t count() const { return this->count_; }
+    uint64_t total() const { return this->total_; }
+    uint64_t min() const { return ( 0 == this->count_ ) ? 0 : this->min_; }
+    uint64_t max() const { return this->max_; }
+    uint64_t bucketCount( size_t i ) const { return this->counts_[i]; }
+
+    // Value below which the given fraction of the recorded values lie (upper bucket bound).
+    uint64_t percentile( double fraction ) const;
+
+    static size_t bucketIndex( uint64_t value );
+
+    // Smallest and largest value counted in a bucket.
+    static uint64_t bucketLowerBound( size_t i );
+    static uint64_t bucketUpperBound( size_t i );
+
+private:
+
+    std::vector<uint64_t> counts_;
+    uint64_t count_;
+    uint64_t total_;
+    uint64_t min_;
+    uint64_t max_;
+};
+
+// Call count and latency histogram for each FMI function called on an FMU instance.
+//
+// The dispatch layer (src/fmi3Functions.cpp) times every call with a Timer, if compiled
+// with FMU_CALL_PROFILING. Latencies are measured in time stamp counter ticks (or in
+// nanoseconds on platforms without TSC) and converted to nanoseconds when written.
+class CallProfiler {
+
+public:
+
+    // Register an FMI function (once per function, thread-safe), returns its call ID.
+    static size_t registerCall( const char* name );
+
+    CallProfiler();
+
+    // Read the time stamp counter.
+    static uint64_t now()
+    {
+#if defined( __x86_64__ ) || defined( __i386__ ) || defined( _M_X64 ) || defined( _M_IX86 )
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count()
+        );
+#endif
+    }
+
+    void record( size_t callId, uint64_t ticks )
+    {
+        if ( callId >= this->histograms_.size() )
+        {
+            this->histograms_.resize( callId + 1 );
+        }
+
+        if ( !this->histograms_[ callId ] )
+        {
+            this->histograms_[ callId ].reset( new LatencyHistogram() );
+        }
+
+        this->histograms_[ callId ]->record( ticks );
+    }
+
+    // Write all histograms in JSON format.
+    void writeJson( FILE* file, const char* instanceName ) const;
+
+    // Times a call from construction to destruction.
+    class Timer {
+
+    public:
+
+        Timer( CallProfiler& profiler, size_t callId ) : profiler_( profiler ), callId_( callId ), start_( now() ) {}
+
+        ~Timer() { this->profiler_.record( this->callId_, now() - this->start_ ); }
+
+    private:
+
+        CallProfiler& profiler_;
+        const size_t callId_;
+        const uint64_t start_;
+    };
+
+private:
+
+    // Ticks per nanosecond, calibrated against the steady clock since construction.
+    double ticksPerNanosecond() const;
+
+    std::vector< std::unique_ptr<LatencyHistogram> > histograms_;
+
+    const uint64_t startTicks_;
+    const std::chrono::steady_clock::time_point startTime_;
+};
+
+#endif // CallProfiler_h
@@ -0,0 +1,240 @@
+/**************************************************************************
+ * Copyright (c) ERIGrid 2.0 (H2020 Programme Grant Agreement No. 870620) *
+ * All rights reserved.                                                   *
+ * See file LICENSE in the project root for license information.          *
+ **************************************************************************/
+
+#ifndef CowArray_h
+#define CowArray_h
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Growable array with copy-on-write semantics, the storage of the event queues.
+//
+// Elements are stored in chunks of 1024, which are listed in a chunk table. Copies of an
+// array share the chunk table and the chunks, hence copying an array takes constant time
+// regardless of its size (used for FMU state snapshots). The first modification of a
+// shared array copies the chunk table (one pointer per chunk), a chunk is copied when one
+// of its elements is modified. As long as an array is not shared, modifications work in
+// place without any checks.
+//
+// Reading and writing are separate operations: operator[] never copies, mutable access
+// goes through at(). The element type must be trivially copyable, since chunks are copied
+// bytewise. Reference counts are not atomic, i.e., an array and its copies must only be
+// used by one thread at a time (as an FMU instance and its states).
+template<typename T>
+class CowArray {
+
+    static_assert(
+        std::is_trivially_copyable<T>::value,
+        "elements of copy-on-write arrays must be trivially copyable"
+    );
+
+public:
+
+    CowArray() : table_( nullptr ), chunks_( nullptr ), size_( 0 ), capacity_( 0 ), shared_( false ) {}
+
+    ~CowArray() { this->release(); }
+
+    CowArray( const CowArray& other ) :
+        table_( other.table_ ),
+        chunks_( other.chunks_ ),
+        size_( other.size_ ),
+        capacity_( other.capacity_ ),
+        shared_( nullptr != other.table_ )
+    {
+        if ( nullptr != this->table_ )
+        {
+            ++this->table_->references;
+            other.shared_ = true;
+        }
+    }
+
+    CowArray& operator=( const CowArray& other )
+    {
+        if ( this->table_ != other.table_ )
+        {
+            this->release();
+            this->table_ = other.table_;
+            this->chunks_ = other.chunks_;
+            this->capacity_ = other.capacity_;
+
+            if ( nullptr != this->table_ )
+            {
+                ++this->table_->references;
+                this->shared_ = true;
+                other.shared_ = true;
+            }
+        }
+
+        this->size_ = other.size_;
+        return *this;
+    }
+
+    size_t size() const { return this->size_; }
+
+    bool empty() const { return 0 == this->size_; }
+
+    // Number of elements that fit into the allocated chunks.
+    size_t capacity() const { return this->capacity_; }
+
+    // Read an element (never copies).
+    const T& operator[]( size_t i ) const
+    {
+        return this->chunks_[ i >> chunkBits ]->items()[ i & chunkMask ];
+    }
+
+    // Read an element and the elements following it in the same chunk (chunks hold 1024
+    // elements, i.e., aligned groups of up to 1024 elements are contiguous).
+    const T* data( size_t i ) const
+    {
+        return this->chunks_[ i >> chunkBits ]->items() + ( i & chunkMask );
+    }
+
+    // Access an element for modification (copies the chunk if it is shared).
+    T& at( size_t i )
+    {
+        if ( this->shared_ ) this->unshareChunk( i >> chunkBits );
+
+        return this->chunks_[ i >> chunkBits ]->items()[ i & chunkMask ];
+    }
+
+    const T& back() const { return ( *this )[ this->size_ - 1 ]; }
+
+    void push_back( const T& value )
+    {
+        if ( this->size_ == this->capacity_ )
+        {
+            Table* table = this->unshareTable();
+            table->chunks.push_back( Chunk::create() );
+            this->chunks_ = table->chunks.data();
+            this->capacity_ = table->chunks.size() * chunkSize;
+        }
+
+        new ( &this->at( this->size_ ) ) T( value );
+        ++this->size_;
+    }
+
+    void pop_back() { --this->size_; }
+
+    // Remove all elements, but keep the allocated chunks for reuse.
+    void clear() { this->size_ = 0; }
+
+    // Remove all elements and give the chunks back (if they are not shared).
+    void release()
+    {
+        if ( ( nullptr != this->table_ ) && ( 0 == --this->table_->references ) )
+        {
+            for ( Chunk* chunk : this->table_->chunks )
+            {
+                if ( 0 == --chunk->references ) ::operator delete( chunk );
+            }
+
+            delete this->table_;
+        }
+
+        this->table_ = nullptr;
+        this->chunks_ = nullptr;
+        this->size_ = 0;
+        this->capacity_ = 0;
+        this->shared_ = false;
+    }
+
+private:
+
+    static const unsigned chunkBits = 10;
+    static const size_t chunkSize = size_t( 1 ) << chunkBits;
+    static const size_t chunkMask = chunkSize - 1;
+
+    // Chunk of elements, allocated as a single block with its reference count.
+    struct Chunk {
+        size_t references;
+
+        T* items() { return reinterpret_cast<T*>( this + 1 ); }
+
+        static size_t bytes() { return sizeof( Chunk ) + chunkSize * sizeof( T ); }
+
+        static Chunk* create()
+        {
+            static_assert( sizeof( Chunk ) % alignof( T ) == 0, "chunk header breaks the alignment of the elements" );
+
+            Chunk* chunk = static_cast<Chunk*>( ::operator new( bytes() ) );
+            chunk->references = 1;
+            return chunk;
+        }
+
+        static Chunk* copy( const Chunk* source )
+        {
+            Chunk* chunk = static_cast<Chunk*>( ::operator new( bytes() ) );
+            std::memcpy( static_cast<void*>( chunk ), source, bytes() );
+            chunk->references = 1;
+            return chunk;
+        }
+    };
+
+    struct Table {
+        size_t references;
+        std::vector<Chunk*> chunks;
+    };
+
+    // Return the chunk table for modification (copied if it is shared).
+    Table* unshareTable()
+    {
+        if ( nullptr == this->table_ )
+        {
+            this->table_ = new Table();
+            this->table_->references = 1;
+        }
+        else if ( 1 != this->table_->references )
+        {
+            Table* table = new Table();
+            table->references = 1;
+            table->chunks = this->table_->chunks;
+
+            for ( Chunk* chunk : table->chunks ) ++chunk->references;
+
+            --this->table_->references;
+            this->table_ = table;
+            this->chunks_ = table->chunks.data();
+        }
+
+        return this->table_;
+    }
+
+    // Make a chunk exclusive to this array (copied if it is shared). Kept out of line, so
+    // that modifications of unshared arrays compile to a test and a store.
+#if defined( _MSC_VER )
+    __declspec( noinline )
+#else
+    __attribute__( ( noinline ) )
+#endif
+    void unshareChunk( size_t c )
+    {
+        Chunk*& chunk = this->unshareTable()->chunks[c];
+
+        if ( 1 != chunk->references )
+        {
+            --chunk->references;
+            chunk = Chunk::copy( chunk );
+        }
+    }
+
+    Table* table_;
+
+    // Chunks of the table (cached, the table is not modified while it is shared).
+    Chunk** chunks_;
+
+    size_t size_;
+    size_t capacity_;
+
+    // The table or some of the chunks may be shared with copies of the array. The array
+    // stays in checked mode until it is released (the copies may outlive modifications).
+    mutable bool shared_;
+};
+
+#endif // CowArray_h
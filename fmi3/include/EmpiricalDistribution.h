@@ -0,0 +1,87 @@
+/**************************************************************************
+ * Copyright (c) ERIGrid 2.0 (H2020 Programme Grant Agreement No. 870620) *
+ * All rights reserved.                                                   *
+ * See file LICENSE in the project root for license information.          *
+ **************************************************************************/
+
+#ifndef EmpiricalDistribution_h
+#define EmpiricalDistribution_h
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "NormalGenerator.h"
+
+// Empirical distribution of delays (seconds), sampled in constant time.
+//
+// The distribution is read from a text file, either as a histogram or as a CDF. Empty
+// lines and lines starting with '#' are ignored, values are separated by whitespace or
+// commas:
+//  - histogram: one bin per line, "lower_bound upper_bound weight" (weights are relative),
+//  - CDF: one point per line, "delay cumulative_probability", with delays and
+//    probabilities non-decreasing (the last probability is taken as 1). The CDF is
+//    interpolated linearly between the points, the probability of the first point is
+//    concentrated at its delay.
+// Either way, the distribution is a set of bins with uniform density within each bin.
+//
+// Bins are chosen with Walker's alias method: a bin is picked uniformly and either kept
+// or replaced by its alias, depending on its threshold. Hence, drawing a sample takes two
+// uniform random numbers and at most two table lookups, regardless of the number of bins.
+// The table is built once by load() (Vose's construction, linear in the number of bins).
+class EmpiricalDistribution {
+
+public:
+
+    EmpiricalDistribution() : mean_( 0. ) {}
+
+    // True if no distribution has been loaded.
+    bool empty() const { return this->bins_.empty(); }
+
+    size_t size() const { return this->bins_.size(); }
+
+    // Mean of the distribution (seconds).
+    double mean() const { return this->mean_; }
+
+    // Read a distribution from a file and build the alias table. Returns false and a
+    // description of the problem if the file cannot be read or is invalid (the
+    // distribution is left unchanged).
+    bool load( const std::string& path, std::string& error );
+
+    // Remove the distribution.
+    void clear()
+    {
+        this->bins_.clear();
+        this->mean_ = 0.;
+    }
+
+    // Draw a delay (seconds).
+    double operator()( NormalGenerator& generator ) const
+    {
+        // The integer part of u selects a bin, its fractional part decides between the bin
+        // and its alias.
+        const double u = generator.uniform() * this->bins_.size();
+        size_t i = static_cast<size_t>( u );
+        if ( i >= this->bins_.size() ) i = this->bins_.size() - 1;
+
+        const Bin& picked = this->bins_[i];
+        const Bin& bin = ( u - i < picked.threshold ) ? picked : this->bins_[ picked.alias ];
+
+        return bin.lower + bin.width * generator.uniform();
+    }
+
+private:
+
+    struct Bin {
+        double lower;
+        double width;
+        double threshold; // probability of keeping the bin instead of its alias
+        uint32_t alias;
+    };
+
+    std::vector<Bin> bins_;
+    double mean_;
+};
+
+#endif // EmpiricalDistribution_h
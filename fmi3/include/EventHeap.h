@@ -0,0 +1,212 @@
+/**************************************************************************
+ * Copyright (c) ERIGrid 2.0 (H2020 Programme Grant Agreement No. 870620) *
+ * All rights reserved.                                                   *
+ * See file LICENSE in the project root for license information.          *
+ **************************************************************************/
+
+#ifndef EventHeap_h
+#define EventHeap_h
+
+#include <cstddef>
+#include <cstdint>
+
+#include "CowArray.h"
+#include "EventSlab.h"
+
+// Priority queue for pipeline events.
+//
+// Events are stored by value in a slab (see EventSlab). The queue order is kept in a
+// 4-ary heap of slab indices, so reordering only moves 32-bit indices. Slab records of
+// removed events are recycled, i.e., once the slab has grown to the maximum number of
+// events in flight no further memory is allocated. Slab and heap are copy-on-write
+// arrays (see CowArray), hence copying a queue (FMU state snapshot) takes constant time.
+// The heap starts at position 3, so that the 4 children of a node are aligned and never
+// span two chunks of the array.
+//
+// The ordering functor must define a strict weak ordering on events (earliest first).
+// Events that are equivalent with respect to this ordering (e.g., events with the same
+// timestamp) form a FIFO bucket, i.e., they leave the queue in the order of insertion.
+template<typename Event, typename Order>
+class EventHeap {
+
+public:
+
+    typedef uint32_t Index;
+
+    EventHeap() : nextArrival_( 0 ) {}
+
+    bool empty() const { return this->heap_.size() <= root; }
+
+    size_t size() const { return this->empty() ? 0 : this->heap_.size() - root; }
+
+    // Access the earliest event (the queue must not be empty).
+    const Event& top() const { return this->slab_[ this->heap_[root] ].event; }
+
+    // Maximum number of events in the queue at the same time.
+    size_t highWaterMark() const { return this->slab_.highWaterMark(); }
+
+    // Insert a new event (copied into the slab).
+    void push( const Event& evt )
+    {
+        // Unused positions in front of the root.
+        while ( this->heap_.size() < root ) this->heap_.push_back( 0 );
+
+        this->heap_.push_back( this->slab_.allocate( Record( evt, this->nextArrival_++ ) ) );
+        this->siftUp( this->heap_.size() - 1 );
+    }
+
+    // Remove the earliest event (the queue must not be empty).
+    void pop()
+    {
+        this->slab_.free( this->heap_[root] );
+
+        this->heap_.at( root ) = this->heap_.back();
+        this->heap_.pop_back();
+
+        if ( false == this->empty() )
+        {
+            this->siftDown( root );
+        }
+    }
+
+    // Visit all events with their arrival numbers, in the order of the heap array
+    // (serialization of FMU states).
+    template<typename Visitor>
+    void visit( Visitor visitor ) const
+    {
+        for ( size_t pos = root; pos < this->heap_.size(); ++pos )
+        {
+            const Record& record = this->slab_[ this->heap_[pos] ];
+            visitor( record.event, record.arrival );
+        }
+    }
+
+    // Arrival number of the next event.
+    uint64_t sequence() const { return this->nextArrival_; }
+
+    // Start restoring a visited queue: remove all events and continue the arrival numbers.
+    void restore( uint64_t sequence )
+    {
+        this->clear();
+        this->nextArrival_ = sequence;
+    }
+
+    // Append an event in the order in which it has been visited, i.e., without reordering.
+    // Returns false if the event violates the heap order (the queue is left unchanged).
+    bool restoreEvent( const Event& evt, uint64_t arrival )
+    {
+        while ( this->heap_.size() < root ) this->heap_.push_back( 0 );
+
+        if ( arrival >= this->nextArrival_ ) return false;
+
+        Index slot = this->slab_.allocate( Record( evt, arrival ) );
+        size_t pos = this->heap_.size();
+
+        if ( ( pos > root ) && this->before( slot, this->heap_[ pos / arity + root - 1 ] ) )
+        {
+            this->slab_.free( slot );
+            return false;
+        }
+
+        this->heap_.push_back( slot );
+        return true;
+    }
+
+    // Remove all events, but keep the allocated storage for reuse.
+    void clear()
+    {
+        this->heap_.clear();
+        this->slab_.clear();
+        this->nextArrival_ = 0;
+    }
+
+    // Remove all events and give the allocated storage back.
+    void release()
+    {
+        this->heap_.release();
+        this->slab_.release();
+        this->nextArrival_ = 0;
+    }
+
+private:
+
+    static const size_t arity = 4;
+
+    // Position of the root in the heap array. The children of the node at position p are
+    // at positions 4p - 8 to 4p - 5.
+    static const size_t root = arity - 1;
+
+    // Slab record: the event and its arrival count (tie-breaker for equivalent events).
+    struct Record {
+        Event event;
+        uint64_t arrival;
+
+        Record( const Event& e, uint64_t a ) : event( e ), arrival( a ) {}
+    };
+
+    // Compare events by the given ordering, equivalent events by their arrival.
+    bool before( Index a, Index b ) const
+    {
+        const Record& ra = this->slab_[a];
+        const Record& rb = this->slab_[b];
+
+        if ( this->order_( ra.event, rb.event ) ) return true;
+        if ( this->order_( rb.event, ra.event ) ) return false;
+        return ra.arrival < rb.arrival;
+    }
+
+    void siftUp( size_t pos )
+    {
+        Index slot = this->heap_[pos];
+
+        while ( pos > root )
+        {
+            size_t parent = pos / arity + root - 1;
+            if ( false == this->before( slot, this->heap_[parent] ) ) break;
+
+            this->heap_.at( pos ) = this->heap_[parent];
+            pos = parent;
+        }
+
+        this->heap_.at( pos ) = slot;
+    }
+
+    void siftDown( size_t pos )
+    {
+        const size_t n = this->heap_.size();
+        Index slot = this->heap_[pos];
+
+        while ( true )
+        {
+            size_t first = ( pos - 2 ) * arity;
+            if ( first >= n ) break;
+
+            // Find the earliest child (the children are contiguous).
+            const Index* children = this->heap_.data( first );
+            size_t count = ( first + arity < n ) ? arity : n - first;
+            size_t child = 0;
+            for ( size_t c = 1; c < count; ++c )
+            {
+                if ( this->before( children[c], children[child] ) ) child = c;
+            }
+
+            if ( false == this->before( children[child], slot ) ) break;
+
+            this->heap_.at( pos ) = children[child];
+            pos = first + child;
+        }
+
+        this->heap_.at( pos ) = slot;
+    }
+
+    // Slab of events, addressed by index.
+    EventSlab<Record> slab_;
+    uint64_t nextArrival_;
+
+    // 4-ary heap of slab indices.
+    CowArray<Index> heap_;
+
+    Order order_;
+};
+
+#endif // EventHeap_h
@@ -0,0 +1,209 @@
+/**************************************************************************
+ * Copyright (c) ERIGrid 2.0 (H2020 Programme Grant Agreement No. 870620) *
+ * All rights reserved.                                                   *
+ * See file LICENSE in the project root for license information.          *
+ **************************************************************************/
+
+#ifndef EventRingBuffer_h
+#define EventRingBuffer_h
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// FIFO queue for pipeline events.
+//
+// Events are stored by value in a ring buffer with a power-of-two capacity. When the
+// buffer is full, its capacity is doubled. Hence, once the buffer has grown to the
+// maximum number of events in flight, no further memory is allocated.
+template<typename Event>
+class EventRingBuffer {
+
+public:
+
+    EventRingBuffer() : head_( 0 ), count_( 0 ), highWaterMark_( 0 ) {}
+
+    bool empty() const { return 0 == this->count_; }
+
+    size_t size() const { return this->count_; }
+
+    size_t capacity() const { return this->buffer_.size(); }
+
+    // Maximum number of events in the buffer at the same time since the last release.
+    size_t highWaterMark() const { return this->highWaterMark_; }
+
+    // Access the oldest event (the buffer must not be empty).
+    const Event& front() const { return this->buffer_[ this->head_ ]; }
+
+    // Append a new event (always succeeds, the buffer grows if needed).
+    bool push( const Event& evt )
+    {
+        if ( this->count_ == this->buffer_.size() )
+        {
+            this->grow( evt );
+        }
+
+        this->buffer_[ ( this->head_ + this->count_ ) & ( this->buffer_.size() - 1 ) ] = evt;
+        if ( ++this->count_ > this->highWaterMark_ )
+        {
+            this->highWaterMark_ = this->count_;
+        }
+
+        return true;
+    }
+
+    // Remove the oldest event (the buffer must not be empty).
+    void pop()
+    {
+        this->head_ = ( this->head_ + 1 ) & ( this->buffer_.size() - 1 );
+        --this->count_;
+    }
+
+    // Remove all events, but keep the allocated storage for reuse.
+    void clear()
+    {
+        this->head_ = 0;
+        this->count_ = 0;
+    }
+
+    // Remove all events and give the allocated storage back.
+    void release()
+    {
+        std::vector<Event>().swap( this->buffer_ );
+        this->clear();
+        this->highWaterMark_ = 0;
+    }
+
+private:
+
+    static const size_t initialCapacity = 16;
+
+    // Double the capacity, the stored events are moved to the front of the new buffer.
+    // The event to be inserted only fills unused slots (no default constructor needed).
+    void grow( const Event& evt )
+    {
+        size_t capacity = this->buffer_.empty() ? initialCapacity : 2 * this->buffer_.size();
+
+        std::vector<Event> buffer;
+        buffer.reserve( capacity );
+
+        for ( size_t i = 0; i < this->count_; ++i )
+        {
+            buffer.push_back( this->buffer_[ ( this->head_ + i ) & ( this->buffer_.size() - 1 ) ] );
+        }
+
+        buffer.resize( capacity, evt );
+
+        this->buffer_.swap( buffer );
+        this->head_ = 0;
+    }
+
+    std::vector<Event> buffer_;
+    size_t head_;
+    size_t count_;
+    size_t highWaterMark_;
+};
+
+// Lock-free FIFO queue for pipeline events with a single producer and a single consumer.
+//
+// The producer thread (e.g., a native sender) calls push(), while the consumer thread
+// (the importer stepping the FMU) calls front() and pop(). The capacity is fixed at
+// construction (rounded up to a power of two), push() fails if the buffer is full.
+// The event type must be default constructible (the storage is preallocated).
+template<typename Event>
+class SpscEventRingBuffer {
+
+public:
+
+    explicit SpscEventRingBuffer( size_t capacity = 65536 ) :
+        buffer_( roundUpToPowerOfTwo( capacity ) ),
+        mask_( buffer_.size() - 1 ),
+        head_( 0 ),
+        tail_( 0 ),
+        highWaterMark_( 0 )
+    {}
+
+    // Consumer side.
+    bool empty() const
+    {
+        return this->head_.load( std::memory_order_relaxed ) == this->tail_.load( std::memory_order_acquire );
+    }
+
+    size_t size() const
+    {
+        return this->tail_.load( std::memory_order_acquire ) - this->head_.load( std::memory_order_acquire );
+    }
+
+    size_t capacity() const { return this->buffer_.size(); }
+
+    // Maximum number of events in the buffer at the same time (as seen by the producer).
+    size_t highWaterMark() const { return this->highWaterMark_.load( std::memory_order_relaxed ); }
+
+    // Access the oldest event (consumer only, the buffer must not be empty).
+    const Event& front() const
+    {
+        return this->buffer_[ this->head_.load( std::memory_order_relaxed ) & this->mask_ ];
+    }
+
+    // Append a new event (producer only). Returns false if the buffer is full.
+    bool push( const Event& evt )
+    {
+        size_t tail = this->tail_.load( std::memory_order_relaxed );
+
+        size_t count = tail - this->head_.load( std::memory_order_acquire );
+
+        if ( count == this->buffer_.size() )
+        {
+            return false;
+        }
+
+        this->buffer_[ tail & this->mask_ ] = evt;
+        this->tail_.store( tail + 1, std::memory_order_release );
+
+        if ( count + 1 > this->highWaterMark_.load( std::memory_order_relaxed ) )
+        {
+            this->highWaterMark_.store( count + 1, std::memory_order_relaxed );
+        }
+
+        return true;
+    }
+
+    // Remove the oldest event (consumer only, the buffer must not be empty).
+    void pop()
+    {
+        this->head_.store( this->head_.load( std::memory_order_relaxed ) + 1, std::memory_order_release );
+    }
+
+    // Remove all events (neither producer nor consumer may be active).
+    void clear()
+    {
+        this->head_.store( 0 );
+        this->tail_.store( 0 );
+    }
+
+    // The storage is preallocated, releasing only resets the positions and statistics.
+    void release()
+    {
+        this->clear();
+        this->highWaterMark_.store( 0 );
+    }
+
+private:
+
+    static size_t roundUpToPowerOfTwo( size_t n )
+    {
+        size_t capacity = 1;
+        while ( capacity < n ) capacity <<= 1;
+        return capacity;
+    }
+
+    std::vector<Event> buffer_;
+    const size_t mask_;
+
+    // Consumer and producer positions, kept on separate cache lines.
+    alignas( 64 ) std::atomic<size_t> head_;
+    alignas( 64 ) std::atomic<size_t> tail_;
+    std::atomic<size_t> highWaterMark_;
+};
+
+#endif // EventRingBuffer_h
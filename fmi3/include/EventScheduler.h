@@ -0,0 +1,163 @@
+/**************************************************************************
+ * Copyright (c) ERIGrid 2.0 (H2020 Programme Grant Agreement No. 870620) *
+ * All rights reserved.                                                   *
+ * See file LICENSE in the project root for license information.          *
+ **************************************************************************/
+
+#ifndef EventScheduler_h
+#define EventScheduler_h
+
+#include <cstddef>
+
+#include "EventHeap.h"
+#include "EventTimingWheel.h"
+
+// Event queue of the pipeline FMUs with a selectable backend:
+//  - heap: 4-ary heap, O(log n) insertion and removal, no assumptions on the events.
+//  - timingWheel: hierarchical timing wheel, O(1) amortized insertion and removal,
+//    suited for many events in flight. Events must not be scheduled before the last
+//    removed event.
+// Both backends deliver events with equal timestamps in FIFO order.
+template<typename Event, typename Order>
+class EventScheduler {
+
+public:
+
+    enum Backend {
+        heap = 0,
+        timingWheel = 1
+    };
+
+    EventScheduler() : backend_( heap ) {}
+
+    static bool isValidBackend( int backend )
+    {
+        return ( heap == backend ) || ( timingWheel == backend );
+    }
+
+    Backend getBackend() const { return this->backend_; }
+
+    // Select the backend. Pending events are moved to the new backend.
+    void setBackend( Backend backend )
+    {
+        if ( backend == this->backend_ ) return;
+
+        Backend previous = this->backend_;
+        this->backend_ = backend;
+
+        while ( false == this->empty( previous ) )
+        {
+            if ( heap == previous )
+            {
+                this->push( this->heap_.top() );
+                this->heap_.pop();
+            }
+            else
+            {
+                this->push( this->wheel_.top() );
+                this->wheel_.pop();
+            }
+        }
+
+        this->release( previous );
+    }
+
+    bool empty() const { return this->empty( this->backend_ ); }
+
+    size_t size() const
+    {
+        return ( timingWheel == this->backend_ ) ? this->wheel_.size() : this->heap_.size();
+    }
+
+    // Maximum number of events in the queue at the same time (current backend).
+    size_t highWaterMark() const
+    {
+        return ( timingWheel == this->backend_ ) ? this->wheel_.highWaterMark() : this->heap_.highWaterMark();
+    }
+
+    // Access the earliest event (the queue must not be empty).
+    const Event& top()
+    {
+        return ( timingWheel == this->backend_ ) ? this->wheel_.top() : this->heap_.top();
+    }
+
+    // Insert a new event.
+    void push( const Event& evt )
+    {
+        if ( timingWheel == this->backend_ ) this->wheel_.push( evt );
+        else this->heap_.push( evt );
+    }
+
+    // Remove the earliest event (the queue must not be empty).
+    void pop()
+    {
+        if ( timingWheel == this->backend_ ) this->wheel_.pop();
+        else this->heap_.pop();
+    }
+
+    // Serialization of FMU states: visit all events with a backend-specific number (the
+    // arrival number for the heap). Restoring the events in the visited order with the
+    // same backend and sequence number rebuilds the queue without reordering.
+    template<typename Visitor>
+    void visit( Visitor visitor ) const
+    {
+        if ( timingWheel == this->backend_ ) this->wheel_.visit( visitor );
+        else this->heap_.visit( visitor );
+    }
+
+    // Backend-specific sequence number (next arrival number of the heap, cursor of the wheel).
+    uint64_t sequence() const
+    {
+        return ( timingWheel == this->backend_ ) ? this->wheel_.sequence() : this->heap_.sequence();
+    }
+
+    // Start restoring a visited queue (all events are removed).
+    void restore( Backend backend, uint64_t sequence )
+    {
+        this->release();
+        this->backend_ = backend;
+
+        if ( timingWheel == this->backend_ ) this->wheel_.restore( sequence );
+        else this->heap_.restore( sequence );
+    }
+
+    // Restore the next visited event. Returns false if the event is inconsistent with the
+    // events restored so far.
+    bool restoreEvent( const Event& evt, uint64_t number )
+    {
+        return ( timingWheel == this->backend_ ) ? this->wheel_.restoreEvent( evt, number ) : this->heap_.restoreEvent( evt, number );
+    }
+
+    // Remove all events, but keep the allocated storage for reuse.
+    void clear()
+    {
+        if ( timingWheel == this->backend_ ) this->wheel_.clear();
+        else this->heap_.clear();
+    }
+
+    // Remove all events and give the allocated storage back.
+    void release()
+    {
+        this->release( this->backend_ );
+    }
+
+private:
+
+    bool empty( Backend backend ) const
+    {
+        return ( timingWheel == backend ) ? this->wheel_.empty() : this->heap_.empty();
+    }
+
+    void release( Backend backend )
+    {
+        if ( timingWheel == backend ) this->wheel_.release();
+        else this->heap_.release();
+    }
+
+    Backend backend_;
+
+    EventHeap<Event, Order> heap_;
+    EventTimingWheel<Event> wheel_;
+};
+
+#endif // EventScheduler_h
@@ -0,0 +1,118 @@
+/**************************************************************************
+ * Copyright (c) ERIGrid 2.0 (H2020 Programme Grant Agreement No. 870620) *
+ * All rights reserved.                                                   *
+ * See file LICENSE in the project root for license information.          *
+ **************************************************************************/
+
+#ifndef EventSlab_h
+#define EventSlab_h
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "CowArray.h"
+
+// Slab allocator for fixed-size event records, owned by a single event queue.
+//
+// Records are handed out from contiguous chunks of equal size and are addressed by a
+// 32-bit index. Chunks never move, hence growing the slab neither copies records nor
+// invalidates references. Released records are recycled through a free list, all
+// chunks are given back at once by release() (or on destruction).
+//
+// The records and the free list are copy-on-write arrays (see CowArray), i.e., copying
+// a slab takes constant time and the copies share their chunks until they are modified.
+// Records are read with operator[] and modified through at().
+//
+// The record type must be trivially copyable, since records are recycled without
+// calling destructors and shared chunks are copied bytewise.
+template<typename Record>
+class EventSlab {
+
+    static_assert(
+        std::is_trivially_copyable<Record>::value,
+        "slab records must be trivially copyable"
+    );
+
+public:
+
+    typedef uint32_t Index;
+
+    EventSlab() : used_( 0 ), highWaterMark_( 0 ) {}
+
+    // Number of records currently in use.
+    size_t size() const { return this->used_; }
+
+    // Number of records that fit into the allocated chunks.
+    size_t capacity() const { return this->records_.capacity(); }
+
+    // Maximum number of records in use at the same time since the last release.
+    size_t highWaterMark() const { return this->highWaterMark_; }
+
+    const Record& operator[]( Index i ) const { return this->records_[i]; }
+
+    // Access a record for modification.
+    Record& at( Index i ) { return this->records_.at( i ); }
+
+    // Copy a record into the slab and return its index.
+    Index allocate( const Record& record )
+    {
+        Index i;
+
+        if ( this->freeSlots_.empty() )
+        {
+            i = static_cast<Index>( this->records_.size() );
+            this->records_.push_back( record );
+        }
+        else
+        {
+            i = this->freeSlots_.back();
+            this->freeSlots_.pop_back();
+            this->records_.at( i ) = record;
+        }
+
+        if ( ++this->used_ > this->highWaterMark_ )
+        {
+            this->highWaterMark_ = this->used_;
+        }
+
+        return i;
+    }
+
+    // Give a record back to the slab (for reuse by later allocations).
+    void free( Index i )
+    {
+        this->freeSlots_.push_back( i );
+        --this->used_;
+    }
+
+    // Recycle all records, but keep the allocated chunks for reuse.
+    void clear()
+    {
+        this->records_.clear();
+        this->freeSlots_.clear();
+        this->used_ = 0;
+    }
+
+    // Recycle all records and give all chunks back.
+    void release()
+    {
+        this->records_.release();
+        this->freeSlots_.release();
+        this->used_ = 0;
+        this->highWaterMark_ = 0;
+    }
+
+private:
+
+    // Records that have been handed out at least once (the slab is filled from the front).
+    CowArray<Record> records_;
+
+    // Released records, reused before new records are taken from the chunks.
+    CowArray<Index> freeSlots_;
+
+    size_t used_;
+    size_t highWaterMark_;
+};
+
+#endif // EventSlab_h
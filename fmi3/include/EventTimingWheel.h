@@ -0,0 +1,307 @@
+/**************************************************************************
+ * Copyright (c) ERIGrid 2.0 (H2020 Programme Grant Agreement No. 870620) *
+ * All rights reserved.                                                   *
+ * See file LICENSE in the project root for license information.          *
+ **************************************************************************/
+
+#ifndef EventTimingWheel_h
+#define EventTimingWheel_h
+
+#include <cstddef>
+#include <cstdint>
+
+#include "EventSlab.h"
+
+#if defined( _MSC_VER )
+#include <intrin.h>
+#endif
+
+// Hierarchical timing wheel for pipeline events.
+//
+// The wheel has 11 levels of 64 slots, covering the full range of 64-bit timestamps.
+// A slot on level l spans 64^l ticks. Each event is placed on the lowest level on which
+// its timestamp and the wheel's cursor (timestamp of the last removed event) differ.
+// All events in a slot on level 0 have the same timestamp and are kept in FIFO order.
+// When the cursor advances, the slots containing the new cursor are cascaded to lower
+// levels. Occupied slots are tracked with one 64-bit mask per level, hence insertion and
+// removal of the earliest event take amortized constant time.
+//
+// Events are stored by value in a slab (see EventSlab), slots are intrusive lists of
+// slab indices.
+// The event type must provide an integer member "timeStamp" (ticks). New events must not
+// be earlier than the last removed event, which holds for the pipelines, since messages
+// are never sent into the past.
+template<typename Event>
+class EventTimingWheel {
+
+public:
+
+    typedef uint32_t Index;
+
+    EventTimingWheel() { this->clear(); }
+
+    bool empty() const { return 0 == this->count_; }
+
+    size_t size() const { return this->count_; }
+
+    // Access the earliest event (the wheel must not be empty).
+    const Event& top()
+    {
+        return this->slab_[ this->findTop() ].event;
+    }
+
+    // Maximum number of events in the wheel at the same time.
+    size_t highWaterMark() const { return this->slab_.highWaterMark(); }
+
+    // Insert a new event (copied into the slab).
+    void push( const Event& evt )
+    {
+        Index node = this->slab_.allocate( Node( evt ) );
+
+        this->link( node );
+        ++this->count_;
+
+        // Equal timestamps leave the wheel in FIFO order, i.e., keep the cached top event.
+        if ( this->topValid_ && ( key( evt ) < key( this->slab_[ this->top_ ].event ) ) )
+        {
+            this->top_ = node;
+        }
+    }
+
+    // Remove the earliest event (the wheel must not be empty).
+    void pop()
+    {
+        Index node = this->findTop();
+
+        // Move the cursor to the earliest event, which moves this event to the head of
+        // its slot on level 0.
+        this->advance( key( this->slab_[node].event ) );
+
+        Bucket& bucket = this->buckets_[0][ this->cursor_ & slotMask ];
+        bucket.head = this->slab_[node].next;
+        if ( none == bucket.head )
+        {
+            bucket.tail = none;
+            this->occupied_[0] &= ~( uint64_t( 1 ) << ( this->cursor_ & slotMask ) );
+        }
+
+        this->slab_.free( node );
+
+        --this->count_;
+        this->topValid_ = false;
+    }
+
+    // Visit all events (serialization of FMU states). Events with equal timestamps share
+    // a slot, they are visited in FIFO order. The second argument is unused (0).
+    template<typename Visitor>
+    void visit( Visitor visitor ) const
+    {
+        for ( unsigned l = 0; l < levels; ++l )
+        {
+            for ( unsigned s = 0; s < slotsPerLevel; ++s )
+            {
+                for ( Index node = this->buckets_[l][s].head; none != node; node = this->slab_[node].next )
+                {
+                    visitor( this->slab_[node].event, uint64_t( 0 ) );
+                }
+            }
+        }
+    }
+
+    // Key of the cursor, i.e., of the last removed event.
+    uint64_t sequence() const { return this->cursor_; }
+
+    // Start restoring a visited wheel: remove all events and set the cursor.
+    void restore( uint64_t sequence )
+    {
+        this->clear();
+        this->cursor_ = sequence;
+    }
+
+    // Insert an event in the order in which it has been visited. Returns false if the event
+    // is earlier than the cursor (the wheel is left unchanged).
+    bool restoreEvent( const Event& evt, uint64_t )
+    {
+        if ( key( evt ) < this->cursor_ ) return false;
+
+        this->push( evt );
+        return true;
+    }
+
+    // Remove all events, but keep the allocated storage for reuse.
+    void clear()
+    {
+        this->slab_.clear();
+        this->reset();
+    }
+
+    // Remove all events and give the allocated storage back.
+    void release()
+    {
+        this->slab_.release();
+        this->reset();
+    }
+
+private:
+
+    static const unsigned levels = 11;
+    static const unsigned bitsPerLevel = 6;
+    static const unsigned slotsPerLevel = 1 << bitsPerLevel;
+    static const uint64_t slotMask = slotsPerLevel - 1;
+    static const Index none = 0xffffffff;
+
+    struct Node {
+        Event event;
+        Index next;
+
+        Node( const Event& e ) : event( e ), next( none ) {}
+    };
+
+    struct Bucket {
+        Index head;
+        Index tail;
+    };
+
+    // Timestamps are mapped to unsigned keys that preserve their order.
+    static uint64_t key( const Event& evt )
+    {
+        return static_cast<uint64_t>( evt.timeStamp ) ^ ( uint64_t( 1 ) << 63 );
+    }
+
+    static unsigned highestBit( uint64_t x )
+    {
+#if defined( _MSC_VER )
+        unsigned long i;
+        _BitScanReverse64( &i, x );
+        return static_cast<unsigned>( i );
+#else
+        return 63 - static_cast<unsigned>( __builtin_clzll( x ) );
+#endif
+    }
+
+    static unsigned lowestBit( uint64_t x )
+    {
+#if defined( _MSC_VER )
+        unsigned long i;
+        _BitScanForward64( &i, x );
+        return static_cast<unsigned>( i );
+#else
+        return static_cast<unsigned>( __builtin_ctzll( x ) );
+#endif
+    }
+
+    void reset()
+    {
+        for ( unsigned l = 0; l < levels; ++l )
+        {
+            for ( unsigned s = 0; s < slotsPerLevel; ++s )
+            {
+                this->buckets_[l][s].head = none;
+                this->buckets_[l][s].tail = none;
+            }
+            this->occupied_[l] = 0;
+        }
+
+        this->cursor_ = 0;
+        this->count_ = 0;
+        this->top_ = none;
+        this->topValid_ = false;
+    }
+
+    // Append an event to the slot matching its timestamp relative to the cursor.
+    void link( Index node )
+    {
+        uint64_t k = key( this->slab_[node].event );
+        uint64_t diff = k ^ this->cursor_;
+        unsigned level = ( 0 == diff ) ? 0 : highestBit( diff ) / bitsPerLevel;
+        unsigned slot = static_cast<unsigned>( ( k >> ( level * bitsPerLevel ) ) & slotMask );
+
+        Bucket& bucket = this->buckets_[level][slot];
+        this->slab_.at( node ).next = none;
+
+        if ( none == bucket.tail )
+        {
+            bucket.head = node;
+            this->occupied_[level] |= uint64_t( 1 ) << slot;
+        }
+        else
+        {
+            this->slab_.at( bucket.tail ).next = node;
+        }
+
+        bucket.tail = node;
+    }
+
+    // Find the earliest event. It is located in the first occupied slot of the lowest
+    // occupied level. Slots on level 0 hold a single timestamp, on higher levels the slot
+    // is scanned (the first of several equal timestamps is the earliest arrival).
+    Index findTop()
+    {
+        if ( this->topValid_ ) return this->top_;
+
+        for ( unsigned l = 0; l < levels; ++l )
+        {
+            if ( 0 == this->occupied_[l] ) continue;
+
+            Index node = this->buckets_[l][ lowestBit( this->occupied_[l] ) ].head;
+            Index best = node;
+
+            if ( l > 0 )
+            {
+                for ( node = this->slab_[node].next; none != node; node = this->slab_[node].next )
+                {
+                    if ( key( this->slab_[node].event ) < key( this->slab_[best].event ) ) best = node;
+                }
+            }
+
+            this->top_ = best;
+            this->topValid_ = true;
+            return best;
+        }
+
+        return none;
+    }
+
+    // Move the cursor forward and cascade the slots that contain the new cursor,
+    // starting from the highest level.
+    void advance( uint64_t cursor )
+    {
+        this->cursor_ = cursor;
+
+        for ( unsigned l = levels - 1; l > 0; --l )
+        {
+            unsigned slot = static_cast<unsigned>( ( cursor >> ( l * bitsPerLevel ) ) & slotMask );
+            if ( 0 == ( this->occupied_[l] & ( uint64_t( 1 ) << slot ) ) ) continue;
+
+            Index node = this->buckets_[l][slot].head;
+            this->buckets_[l][slot].head = none;
+            this->buckets_[l][slot].tail = none;
+            this->occupied_[l] &= ~( uint64_t( 1 ) << slot );
+
+            while ( none != node )
+            {
+                Index next = this->slab_[node].next;
+                this->link( node );
+                node = next;
+            }
+        }
+    }
+
+    // Slab of events, addressed by index.
+    EventSlab<Node> slab_;
+
+    // Slots of all levels (intrusive FIFO lists of slab indices) and their occupancy.
+    Bucket buckets_[levels][slotsPerLevel];
+    uint64_t occupied_[levels];
+
+    // Key of the last removed event, no event in the wheel is earlier.
+    uint64_t cursor_;
+
+    size_t count_;
+
+    // Cached earliest event.
+    Index top_;
+    bool topValid_;
+};
+
+#endif // EventTimingWheel_h
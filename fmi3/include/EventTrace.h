@@ -0,0 +1,122 @@
+/**************************************************************************
+ * Copyright (c) ERIGrid 2.0 (H2020 Programme Grant Agreement No. 870620) *
+ * All rights reserved.                                                   *
+ * See file LICENSE in the project root for license information.          *
+ **************************************************************************/
+
+#ifndef EventTrace_h
+#define EventTrace_h
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Binary trace of the messages passing through a pipeline, written to a memory-mapped file.
+//
+// The file consists of a header and a fixed number of records, written as a ring (the
+// oldest records are overwritten when the trace is full). Hence, the file size is fixed
+// when the trace is opened. Records are written directly into the mapping, so appending
+// a record costs a few stores. The operating system writes the mapping back to the file,
+// which also happens if the process crashes. Each record carries its sequence number,
+// which is stored last: records with sequence number 0 are incomplete (or unused).
+//
+// Use tools/trace_reader to convert a trace to CSV.
+namespace EventTraceFormat
+{
+    // Magic number at the start of a trace file ("FMUTRACE").
+    static const uint64_t magic = 0x4543415254554d46ULL;
+
+    static const uint32_t version = 1;
+
+    enum RecordKind : uint8_t {
+        ingress = 0, // a message has been received (time: input time, delay: sampled delay)
+        egress = 1   // a message has been delivered (time: delivery time)
+    };
+
+    struct Header {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t recordSize;
+        uint64_t capacity;       // number of records in the file
+        int64_t ticksPerSecond;  // unit of all times in the records
+        uint64_t count;          // number of records written so far (including overwritten ones)
+        uint64_t reserved[3];
+    };
+
+    struct Record {
+        uint64_t sequence;  // 1-based sequence number (0: incomplete or unused)
+        int64_t time;       // ticks
+        int64_t delay;      // ticks (ingress only)
+        int32_t msgId;
+        uint16_t channel;
+        uint8_t kind;       // RecordKind
+        uint8_t reserved;
+    };
+
+    static_assert( sizeof( Header ) == 64, "trace header is expected to be 64 bytes" );
+    static_assert( sizeof( Record ) == 32, "trace records are expected to be 32 bytes" );
+}
+
+class EventTrace {
+
+public:
+
+    EventTrace() : header_( nullptr ), records_( nullptr ), capacity_( 0 ), count_( 0 ), mapping_( nullptr ), mappingSize_( 0 ) {}
+
+    ~EventTrace() { this->close(); }
+
+    EventTrace( const EventTrace& ) = delete;
+    EventTrace& operator=( const EventTrace& ) = delete;
+
+    // Create (or overwrite) a trace file for the given number of records. Returns false
+    // if the file cannot be created or mapped.
+    bool open( const std::string& path, size_t capacity, int64_t ticksPerSecond );
+
+    // Unmap the file (the trace remains on disk).
+    void close();
+
+    bool isOpen() const { return nullptr != this->records_; }
+
+    void recordIngress( int64_t time, int64_t delay, int32_t msgId, uint16_t channel )
+    {
+        if ( nullptr != this->records_ ) this->append( EventTraceFormat::ingress, time, delay, msgId, channel );
+    }
+
+    void recordEgress( int64_t time, int32_t msgId, uint16_t channel )
+    {
+        if ( nullptr != this->records_ ) this->append( EventTraceFormat::egress, time, 0, msgId, channel );
+    }
+
+private:
+
+    void append( EventTraceFormat::RecordKind kind, int64_t time, int64_t delay, int32_t msgId, uint16_t channel )
+    {
+        EventTraceFormat::Record& record = this->records_[ this->count_ % this->capacity_ ];
+
+        // Invalidate the record while it is being written.
+        record.sequence = 0;
+        std::atomic_signal_fence( std::memory_order_release );
+
+        record.time = time;
+        record.delay = delay;
+        record.msgId = msgId;
+        record.channel = channel;
+        record.kind = kind;
+        record.reserved = 0;
+
+        std::atomic_signal_fence( std::memory_order_release );
+        record.sequence = ++this->count_;
+        this->header_->count = this->count_;
+    }
+
+    EventTraceFormat::Header* header_;
+    EventTraceFormat::Record* records_;
+    uint64_t capacity_;
+    uint64_t count_;
+
+    void* mapping_;
+    size_t mappingSize_;
+};
+
+#endif // EventTrace_h
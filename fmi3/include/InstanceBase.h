@@ -7,15 +7,20 @@
 #ifndef InstanceBase_h
 #define InstanceBase_h
 
+#include <algorithm>
 #include <cstdarg>
+#include <limits>
 #include <string>
 #include <vector>
 
 #include "fmi3FunctionTypes.h"
 #include "fmi3Functions.h"
 
+#include "AsyncLogger.h"
+#include "CallProfiler.h"
 #include "FMUMode.h"
-
+#include "LogCategory.h"
+#include "VariableTable.h"
 
 class InstanceBase {
 
@@ -407,7 +412,16 @@ public:
         fmi3Float64* lastSuccessfulTime
     );
 
-    FMUMode getMode() { return this->mode_; }
+    FMUMode getMode() const { return this->mode_; }
+
+#ifdef FMU_CALL_PROFILING
+    CallProfiler& getCallProfiler() { return this->callProfiler_; }
+
+    // Write the call profile in JSON format to a file. Without a file name, the profile is
+    // written to "<instance name>.calls.json" in the directory given by the environment
+    // variable FMU_CALL_PROFILE_DIR (default: working directory).
+    fmi3Status writeCallProfile( fmi3String fileName );
+#endif
 
     void logMessage(
         fmi3Status status,
@@ -416,11 +430,24 @@ public:
     va_list args
     );
 
+    // Debug message of a log category. The message is only formatted if debug logging is
+    // enabled for the category (see setDebugLogging), calls are compiled out entirely if
+    // FMU_MIN_LOG_LEVEL is above FMU_LOG_LEVEL_DEBUG (see LogCategory.h).
+    template<typename... Args>
     void logDebug(
+        LogCategory category,
         const char *message,
-        ...
-    );
+        Args... args
+    ) {
+#if FMU_MIN_LOG_LEVEL <= FMU_LOG_LEVEL_DEBUG
+        if ( 0 != ( this->debugLogCategories_ & category ) )
+        {
+            this->logDebugMessage( category, message, args... );
+        }
+#endif
+    }
 
+    // Error message, passed to the importer before the call returns (see AsyncLogger).
     void logError(
         const char *message,
         ...
@@ -445,7 +472,7 @@ protected:
     }
 
     bool getLoggingOn() { 
-        return this->loggingOn_;
+        return 0 != this->debugLogCategories_;
     }
 
     bool getEventModeUsed() { 
@@ -476,13 +503,76 @@ protected:
         this->mode_ = mode; 
     }
 
+    // Path of a file in the resource directory (absolute paths are returned unchanged).
+    std::string getResourceFile( const std::string& fileName );
+
+    // Path of a file written by the FMU: in the directory given by an environment variable
+    // or, if it is not set, in the resource directory (see getResourceFile).
+    std::string getOutputFile( const std::string& fileName, const char* environmentVariable );
+
+    // Bulk access to the variables of a lookup table (see VariableTable.h): one lookup per
+    // value reference, scalar values are copied directly, arrays with a single copy. The
+    // values passed by the importer are of type V, which differs from the type T of the
+    // variables for strings (see exportValue).
+    template<typename T, typename V>
+    fmi3Status getVariables(
+        const VariableTable<T>& table,
+        const fmi3ValueReference valueReferences[],
+        size_t nValueReferences,
+        V values[],
+        size_t nValues
+    );
+
+    template<typename T, typename V>
+    fmi3Status setVariables(
+        VariableTable<T>& table,
+        const fmi3ValueReference valueReferences[],
+        size_t nValueReferences,
+        const V values[],
+        size_t nValues
+    );
+
+    // Variables of the FMU, bound to the members of the derived class in its constructor.
+    // The default implementations of the getters and setters serve these tables.
+    VariableTable<fmi3Float32> float32Table_;
+    VariableTable<fmi3Float64> float64Table_;
+    VariableTable<fmi3Int8> int8Table_;
+    VariableTable<fmi3UInt8> uInt8Table_;
+    VariableTable<fmi3Int16> int16Table_;
+    VariableTable<fmi3UInt16> uInt16Table_;
+    VariableTable<fmi3Int32> int32Table_;
+    VariableTable<fmi3UInt32> uInt32Table_;
+    VariableTable<fmi3Int64> int64Table_;
+    VariableTable<fmi3UInt64> uInt64Table_;
+    VariableTable<fmi3Boolean> booleanTable_;
+    VariableTable<fmi3Clock> clockTable_;
+
+    // String variables are held in members of type std::string.
+    VariableTable<std::string> stringTable_;
+
 private:
 
+    // Copy the value of a variable to the importer. Strings are passed as C strings, which
+    // stay valid until the variable is changed.
+    template<typename T>
+    static void exportValue( const T& value, T& v ) { v = value; }
+
+    static void exportValue( const std::string& value, fmi3String& v ) { v = value.c_str(); }
+
+    template<typename T>
+    static void exportValues( const std::vector<T>& values, T* v ) { std::copy( values.begin(), values.end(), v ); }
+
+    static void exportValues( const std::vector<std::string>& values, fmi3String* v )
+    {
+        for ( const std::string& value : values ) *v++ = value.c_str();
+    }
+
     const std::string instanceName_;
     const std::string instantiationToken_;
     const std::string resourceLocation_;
     const bool visible_;
-    const bool loggingOn_;
+    // Enabled log categories (bitmask of LogCategory, 0 if debug logging is off).
+    unsigned debugLogCategories_;
     const bool eventModeUsed_;
     const bool earlyReturnAllowed_;
     const std::vector<fmi3ValueReference> requiredIntermediateVariables_;
@@ -492,7 +582,140 @@ private:
     const fmi3LogMessageCallback logger_;
     const fmi3IntermediateUpdateCallback intermediateUpdate_;
 
+    // Log messages are passed to logger_ by a background thread (see AsyncLogger.h).
+    AsyncLogger log_;
+
+#ifdef FMU_CALL_PROFILING
+    // Latencies of the FMI function calls, recorded by the dispatch layer.
+    CallProfiler callProfiler_;
+#endif
+
     FMUMode mode_;
+
+    void logDebugMessage(
+        LogCategory category,
+        const char *message,
+        ...
+    );
 };
 
+template<typename T, typename V>
+fmi3Status
+InstanceBase::getVariables(
+    const VariableTable<T>& table,
+    const fmi3ValueReference valueReferences[],
+    size_t nValueReferences,
+    V values[],
+    size_t nValues
+) {
+    V* v = values;
+    size_t remaining = nValues;
+
+    for ( const fmi3ValueReference* vr = valueReferences; vr != valueReferences + nValueReferences; ++vr )
+    {
+        const typename VariableTable<T>::Entry* entry = table.find( *vr );
+
+        if ( nullptr == entry )
+        {
+            this->logError( "Invalid value reference: %d", *vr );
+            return fmi3Error;
+        }
+
+        size_t n = entry->scalar ? 1 : entry->array->size();
+
+        if ( remaining < n )
+        {
+            this->logError( "The number of values does not match the value references!" );
+            return fmi3Error;
+        }
+
+        if ( entry->scalar ) exportValue( *entry->scalar, *v );
+        else exportValues( *entry->array, v );
+
+        v += n;
+        remaining -= n;
+    }
+
+    if ( 0 != remaining )
+    {
+        this->logError( "The number of values does not match the value references!" );
+        return fmi3Error;
+    }
+
+    this->logDebug( logIo, "get %zu variables (%zu values)", nValueReferences, static_cast<size_t>( v - values ) );
+
+    return fmi3OK;
+}
+
+template<typename T, typename V>
+fmi3Status
+InstanceBase::setVariables(
+    VariableTable<T>& table,
+    const fmi3ValueReference valueReferences[],
+    size_t nValueReferences,
+    const V values[],
+    size_t nValues
+) {
+    const V* v = values;
+    size_t remaining = nValues;
+
+    for ( const fmi3ValueReference* vr = valueReferences; vr != valueReferences + nValueReferences; ++vr )
+    {
+        const typename VariableTable<T>::Entry* entry = table.find( *vr );
+
+        if ( nullptr == entry )
+        {
+            this->logError( "Invalid value reference: %d", *vr );
+            return fmi3Error;
+        }
+
+        switch ( entry->causality )
+        {
+            case outputVariable:
+                this->logError( "Output variable %d cannot be set", *vr );
+                return fmi3Error;
+            case structuralParameterVariable:
+                if ( 0 == ( this->mode_ & ( instantiated | configurationMode ) ) )
+                {
+                    this->logError( "Structural parameter %d can only be set in configuration mode", *vr );
+                    return fmi3Error;
+                }
+                break;
+            case parameterVariable:
+                if ( 0 == ( this->mode_ & ( instantiated | initializationMode | configurationMode ) ) )
+                {
+                    this->logError( "Parameter %d can only be set before initialization is finished", *vr );
+                    return fmi3Error;
+                }
+                break;
+            default:
+                break;
+        }
+
+        size_t n = entry->scalar ? 1 : entry->array->size();
+
+        if ( remaining < n )
+        {
+            this->logError( "The number of values does not match the value references!" );
+            return fmi3Error;
+        }
+
+        if ( entry->scalar ) *entry->scalar = *v;
+        else std::copy( v, v + n, entry->array->begin() );
+
+        v += n;
+        remaining -= n;
+    }
+
+    if ( 0 != remaining )
+    {
+        this->logError( "The number of values does not match the value references!" );
+        return fmi3Error;
+    }
+
+    this->logDebug( logIo, "set %zu variables (%zu values)", nValueReferences, static_cast<size_t>( v - values ) );
+
+    return fmi3OK;
+}
+
 #endif // InstanceBase_h
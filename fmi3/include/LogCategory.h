@@ -0,0 +1,64 @@
+/**************************************************************************
+ * Copyright (c) ERIGrid 2.0 (H2020 Programme Grant Agreement No. 870620) *
+ * All rights reserved.                                                   *
+ * See file LICENSE in the project root for license information.          *
+ **************************************************************************/
+
+#ifndef LogCategory_h
+#define LogCategory_h
+
+#include <cstring>
+
+// Minimum log level compiled into the FMU. With FMU_MIN_LOG_LEVEL=FMU_LOG_LEVEL_ERROR,
+// debug messages are removed at compile time (no formatting, no category checks).
+#define FMU_LOG_LEVEL_DEBUG 0
+#define FMU_LOG_LEVEL_ERROR 1
+
+#ifndef FMU_MIN_LOG_LEVEL
+#define FMU_MIN_LOG_LEVEL FMU_LOG_LEVEL_DEBUG
+#endif
+
+// Categories of debug messages, enabled at runtime through setDebugLogging (bitmask).
+// The names are declared as log categories in FMI3.xml.
+enum LogCategory : unsigned {
+    logQueue    = 1 << 0, // "queue": event queue operations
+    logStep     = 1 << 1, // "step": communication steps
+    logIo       = 1 << 2, // "io": getting and setting variables
+    logClock    = 1 << 3, // "clock": clocks and event times
+    logInstance = 1 << 4  // "instance": instantiation and life cycle
+};
+
+static const unsigned allLogCategories = logQueue | logStep | logIo | logClock | logInstance;
+
+inline const char* logCategoryName( LogCategory category )
+{
+    switch ( category )
+    {
+        case logQueue: return "queue";
+        case logStep: return "step";
+        case logIo: return "io";
+        case logClock: return "clock";
+        case logInstance: return "instance";
+    }
+
+    return "DEBUG";
+}
+
+// Find a log category by its name, returns false for unknown names.
+inline bool findLogCategory( const char* name, LogCategory& category )
+{
+    static const LogCategory categories[] = { logQueue, logStep, logIo, logClock, logInstance };
+
+    for ( LogCategory c : categories )
+    {
+        if ( 0 == std::strcmp( name, logCategoryName( c ) ) )
+        {
+            category = c;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+#endif // LogCategory_h
@@ -0,0 +1,355 @@
+/**************************************************************************
+ * Copyright (c) ERIGrid 2.0 (H2020 Programme Grant Agreement No. 870620) *
+ * All rights reserved.                                                   *
+ * See file LICENSE in the project root for license information.          *
+ **************************************************************************/
+
+#ifndef NormalGenerator_h
+#define NormalGenerator_h
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+// Reproducible generator of standard normal samples, the source of the random delays.
+//
+// The engines and distributions of the standard library are implementation-defined (the
+// same seed gives different delays with different standard libraries). This generator
+// defines every step itself, hence the same seed gives bit-identical sequences with all
+// compilers and platforms:
+//  - The engine consists of four interleaved xoshiro256++ streams, seeded with splitmix64.
+//    The streams are stored lane by lane, i.e., one step of all four is a loop over
+//    adjacent 64-bit words that compilers vectorize (adds, shifts and xors only).
+//  - Samples are drawn with the ziggurat method (Marsaglia and Tsang, 128 layers, in the
+//    formulation of Doornik). One random word gives the layer (bits 0-6) and a uniform
+//    value in (-1, 1) (bits 11-63). About 98.8% of the words are accepted by a comparison
+//    with a table entry.
+//  - Exponentials and logarithms (tables, wedges and tail) are computed by the functions
+//    of this class with basic arithmetic only, which IEEE 754 rounds identically everywhere.
+//    The FMUs are compiled without floating-point contraction (see CMakeLists.txt), so that
+//    no fused multiply-adds change the rounding.
+//
+// Samples are produced in blocks of 256: the fast path is evaluated for the whole block in
+// one loop, the few rejected words are completed afterwards in order. A block is filled
+// lazily when the previous one has been used up.
+//
+// Uniform samples (empirical distributions, see EmpiricalDistribution.h) are drawn from the
+// first stream directly, without blocks.
+//
+// The generator is copyable (FMU state snapshots). Its state can be saved as a checkpoint,
+// i.e., the engine state, the engine state at the start of the current block and the
+// position in the block.
+class NormalGenerator {
+
+public:
+
+    // Number of interleaved engine streams.
+    static const unsigned lanes = 4;
+
+    // Number of samples per block.
+    static const unsigned blockSize = 256;
+
+    // Engine state, engine state at the start of the current block and the number of
+    // samples used from the block.
+    struct Checkpoint {
+        uint64_t engine[4][lanes];
+        uint64_t blockStart[4][lanes];
+        uint32_t position;
+    };
+
+    explicit NormalGenerator( uint64_t seed = 1 ) { this->seed( seed ); }
+
+    // Restart the sequence (the next sample starts a new block).
+    void seed( uint64_t seed )
+    {
+        uint64_t x = seed;
+
+        for ( unsigned w = 0; w < 4; ++w )
+        {
+            for ( unsigned l = 0; l < lanes; ++l )
+            {
+                this->engine_[w][l] = splitMix64( x );
+                this->blockStart_[w][l] = this->engine_[w][l];
+            }
+        }
+
+        this->position_ = blockSize;
+    }
+
+    // Next standard normal sample.
+    double operator()()
+    {
+        if ( blockSize == this->position_ ) this->refill();
+
+        return this->block_[ this->position_++ ];
+    }
+
+    // Next uniform sample in (0, 1).
+    double uniform() { return openUniform( this->nextWord() ); }
+
+    Checkpoint checkpoint() const
+    {
+        Checkpoint checkpoint;
+
+        for ( unsigned w = 0; w < 4; ++w )
+        {
+            for ( unsigned l = 0; l < lanes; ++l )
+            {
+                checkpoint.engine[w][l] = this->engine_[w][l];
+                checkpoint.blockStart[w][l] = this->blockStart_[w][l];
+            }
+        }
+
+        checkpoint.position = this->position_;
+        return checkpoint;
+    }
+
+    // Continue the sequence from a checkpoint (refills the block it has been taken in).
+    // Returns false if the checkpoint is invalid (the generator is left unchanged).
+    bool restore( const Checkpoint& checkpoint )
+    {
+        if ( blockSize < checkpoint.position ) return false;
+
+        for ( unsigned w = 0; w < 4; ++w )
+        {
+            for ( unsigned l = 0; l < lanes; ++l ) this->engine_[w][l] = checkpoint.blockStart[w][l];
+        }
+
+        if ( blockSize != checkpoint.position ) this->refill();
+
+        for ( unsigned w = 0; w < 4; ++w )
+        {
+            for ( unsigned l = 0; l < lanes; ++l ) this->engine_[w][l] = checkpoint.engine[w][l];
+        }
+
+        this->position_ = checkpoint.position;
+        return true;
+    }
+
+    // Exponential function, computed identically on all platforms (relative error < 1e-15).
+    static double exp( double x )
+    {
+        // x = k ln(2) + r with |r| <= ln(2)/2 (Cody-Waite reduction, ln(2) split in two parts).
+        const double k = std::floor( x * 1.4426950408889634 + 0.5 );
+        const double r = ( x - k * 6.93147180369123816490e-01 ) - k * 1.90821492927058770002e-10;
+
+        // Taylor polynomial of degree 13 (Horner scheme).
+        double p = 1. / 6227020800.;
+        static const double coefficients[] = {
+            1. / 479001600., 1. / 39916800., 1. / 3628800., 1. / 362880., 1. / 40320., 1. / 5040.,
+            1. / 720., 1. / 120., 1. / 24., 1. / 6., 1. / 2., 1., 1.
+        };
+        for ( double c : coefficients ) p = p * r + c;
+
+        return std::ldexp( p, static_cast<int>( k ) );
+    }
+
+    // Natural logarithm of a positive number, computed identically on all platforms.
+    static double log( double x )
+    {
+        // x = m 2^e with sqrt(1/2) <= m < sqrt(2).
+        int e;
+        double m = std::frexp( x, &e );
+        if ( m < 0.70710678118654752440 )
+        {
+            m *= 2.;
+            --e;
+        }
+
+        // log(m) = 2 atanh(s) with s = (m - 1) / (m + 1), |s| < 0.172 (odd series up to s^25).
+        const double s = ( m - 1. ) / ( m + 1. );
+        const double s2 = s * s;
+
+        double p = 1. / 25.;
+        for ( int n = 23; n >= 1; n -= 2 ) p = p * s2 + 1. / n;
+
+        return e * 0.69314718055994530942 + 2. * s * p;
+    }
+
+private:
+
+    static const unsigned layers = 128;
+
+    // Start of the tail, area of a layer (Marsaglia and Tsang).
+    static constexpr double tailStart = 3.442619855899;
+    static constexpr double layerArea = 9.91256303526217e-3;
+
+    // Layer boundaries x[i] and ratios x[i+1]/x[i] (fast acceptance test of layer i).
+    struct Tables {
+        double x[layers + 1];
+        double ratio[layers];
+
+        Tables()
+        {
+            double f = NormalGenerator::exp( -.5 * tailStart * tailStart );
+            this->x[0] = layerArea / f;
+            this->x[1] = tailStart;
+            this->x[layers] = 0.;
+
+            for ( unsigned i = 2; i < layers; ++i )
+            {
+                this->x[i] = std::sqrt( -2. * NormalGenerator::log( layerArea / this->x[i - 1] + f ) );
+                f = NormalGenerator::exp( -.5 * this->x[i] * this->x[i] );
+            }
+
+            for ( unsigned i = 0; i < layers; ++i ) this->ratio[i] = this->x[i + 1] / this->x[i];
+        }
+    };
+
+    static const Tables& tables()
+    {
+        static const Tables tables;
+        return tables;
+    }
+
+    static uint64_t splitMix64( uint64_t& x )
+    {
+        uint64_t z = ( x += 0x9e3779b97f4a7c15ULL );
+        z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+        z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebULL;
+        return z ^ ( z >> 31 );
+    }
+
+    static uint64_t rotl( uint64_t x, int k ) { return ( x << k ) | ( x >> ( 64 - k ) ); }
+
+    // One step of all engine streams.
+    void next( uint64_t* words )
+    {
+        uint64_t* s0 = this->engine_[0];
+        uint64_t* s1 = this->engine_[1];
+        uint64_t* s2 = this->engine_[2];
+        uint64_t* s3 = this->engine_[3];
+
+        for ( unsigned l = 0; l < lanes; ++l )
+        {
+            words[l] = rotl( s0[l] + s3[l], 23 ) + s0[l];
+
+            const uint64_t t = s1[l] << 17;
+            s2[l] ^= s0[l];
+            s3[l] ^= s1[l];
+            s1[l] ^= s2[l];
+            s0[l] ^= s3[l];
+            s2[l] ^= t;
+            s3[l] = rotl( s3[l], 45 );
+        }
+    }
+
+    // One word from the first stream (rejected samples, the other streams are not advanced).
+    uint64_t nextWord()
+    {
+        uint64_t* s0 = this->engine_[0];
+        uint64_t* s1 = this->engine_[1];
+        uint64_t* s2 = this->engine_[2];
+        uint64_t* s3 = this->engine_[3];
+
+        const uint64_t word = rotl( s0[0] + s3[0], 23 ) + s0[0];
+        const uint64_t t = s1[0] << 17;
+        s2[0] ^= s0[0];
+        s3[0] ^= s1[0];
+        s1[0] ^= s2[0];
+        s0[0] ^= s3[0];
+        s2[0] ^= t;
+        s3[0] = rotl( s3[0], 45 );
+
+        return word;
+    }
+
+    // Uniform value in (-1, 1) from the upper 53 bits of a word.
+    static double signedUniform( uint64_t word )
+    {
+        return static_cast<double>( static_cast<int64_t>( word ) >> 11 ) * ( 1. / 4503599627370496. );
+    }
+
+    // Uniform value in (0, 1) from the upper 53 bits of a word.
+    static double openUniform( uint64_t word )
+    {
+        return ( static_cast<double>( word >> 11 ) + .5 ) * ( 1. / 9007199254740992. );
+    }
+
+    // Fill the next block: fast path for all words, then the rejected words in order.
+    void refill()
+    {
+        const Tables& t = tables();
+
+        for ( unsigned w = 0; w < 4; ++w )
+        {
+            for ( unsigned l = 0; l < lanes; ++l ) this->blockStart_[w][l] = this->engine_[w][l];
+        }
+
+        uint64_t words[blockSize];
+        bool accepted[blockSize];
+
+        for ( unsigned i = 0; i < blockSize; i += lanes )
+        {
+            this->next( words + i );
+
+            for ( unsigned l = 0; l < lanes; ++l )
+            {
+                const unsigned layer = words[i + l] & ( layers - 1 );
+                const double u = signedUniform( words[i + l] );
+
+                this->block_[i + l] = u * t.x[layer];
+                accepted[i + l] = std::fabs( u ) < t.ratio[layer];
+            }
+        }
+
+        for ( unsigned i = 0; i < blockSize; ++i )
+        {
+            if ( false == accepted[i] ) this->block_[i] = this->slowPath( words[i] );
+        }
+
+        this->position_ = 0;
+    }
+
+    // Complete a sample that has not been accepted by the fast path (wedge or tail).
+    double slowPath( uint64_t word )
+    {
+        const Tables& t = tables();
+
+        while ( true )
+        {
+            const unsigned layer = word & ( layers - 1 );
+            const double u = signedUniform( word );
+
+            if ( std::fabs( u ) < t.ratio[layer] ) return u * t.x[layer];
+
+            if ( 0 == layer ) return this->tail( u < 0. );
+
+            // Wedge: accept if a uniform point lies below the density.
+            const double x = u * t.x[layer];
+            const double f0 = exp( -.5 * ( t.x[layer] * t.x[layer] - x * x ) );
+            const double f1 = exp( -.5 * ( t.x[layer + 1] * t.x[layer + 1] - x * x ) );
+
+            if ( f1 + openUniform( this->nextWord() ) * ( f0 - f1 ) < 1. ) return x;
+
+            word = this->nextWord();
+        }
+    }
+
+    // Sample from the tail beyond tailStart (Marsaglia).
+    double tail( bool negative )
+    {
+        double x;
+        double y;
+
+        do
+        {
+            x = log( openUniform( this->nextWord() ) ) / tailStart;
+            y = log( openUniform( this->nextWord() ) );
+        }
+        while ( -2. * y < x * x );
+
+        return negative ? x - tailStart : tailStart - x;
+    }
+
+    // Engine state (words of the streams, lane by lane).
+    uint64_t engine_[4][lanes];
+
+    // Engine state at the start of the current block (checkpoints).
+    uint64_t blockStart_[4][lanes];
+
+    double block_[blockSize];
+    unsigned position_;
+};
+
+#endif // NormalGenerator_h
@@ -0,0 +1,154 @@
+/**************************************************************************
+ * Copyright (c) ERIGrid 2.0 (H2020 Programme Grant Agreement No. 870620) *
+ * All rights reserved.                                                   *
+ * See file LICENSE in the project root for license information.          *
+ **************************************************************************/
+
+#ifndef PayloadPool_h
+#define PayloadPool_h
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "fmi3PlatformTypes.h"
+
+// Reference-counted pool of binary message payloads, owned by a single pipeline.
+//
+// All payload buffers are allocated at once by allocate(), as equally sized slots of a
+// single contiguous block. A payload is copied into a slot exactly once, when the
+// importer sets it. From then on, the input variable, every event in flight and the
+// output variable refer to the slot by its 16-bit handle, and the importer gets a
+// pointer into the slot at delivery. A slot is recycled as soon as its last reference
+// has been removed. Hence, no memory is allocated per message.
+class PayloadPool {
+
+public:
+
+    typedef uint16_t Handle;
+
+    // Handle of an empty payload (no slot).
+    static constexpr Handle none = 0xFFFF;
+
+    // Maximum number of slots (all other handles are valid slot indices).
+    static constexpr size_t maxSlots = none;
+
+    PayloadPool() : slotSize_( 0 ), highWaterMark_( 0 ) {}
+
+    PayloadPool( const PayloadPool& ) = delete;
+    PayloadPool& operator=( const PayloadPool& ) = delete;
+
+    // Number of slots.
+    size_t capacity() const { return this->refCounts_.size(); }
+
+    // Maximum size of a payload (bytes).
+    size_t slotSize() const { return this->slotSize_; }
+
+    // Number of slots currently in use.
+    size_t size() const { return this->capacity() - this->freeSlots_.size(); }
+
+    // Maximum number of slots in use at the same time since the last allocation.
+    size_t highWaterMark() const { return this->highWaterMark_; }
+
+    // Allocate the storage for a number of payloads of at most slotSize bytes each. All
+    // previous payloads are discarded. The number of slots must not exceed maxSlots.
+    void allocate( size_t nSlots, size_t slotSize )
+    {
+        this->storage_.assign( nSlots * slotSize, 0 );
+        this->slotSize_ = slotSize;
+        this->sizes_.assign( nSlots, 0 );
+        this->refCounts_.assign( nSlots, 0 );
+        this->freeSlots_.clear();
+        this->freeSlots_.reserve( nSlots );
+
+        // Slots are handed out in ascending order.
+        for ( size_t i = nSlots; i > 0; --i )
+        {
+            this->freeSlots_.push_back( static_cast<Handle>( i - 1 ) );
+        }
+
+        this->highWaterMark_ = 0;
+    }
+
+    // Give the storage back.
+    void release()
+    {
+        std::vector<fmi3Byte>().swap( this->storage_ );
+        std::vector<size_t>().swap( this->sizes_ );
+        std::vector<uint32_t>().swap( this->refCounts_ );
+        std::vector<Handle>().swap( this->freeSlots_ );
+        this->slotSize_ = 0;
+        this->highWaterMark_ = 0;
+    }
+
+    // Copy a payload into a free slot, with a single reference. Returns none if the
+    // payload is too large or no slot is free.
+    Handle acquire( fmi3Binary data, size_t size )
+    {
+        if ( ( size > this->slotSize_ ) || this->freeSlots_.empty() )
+        {
+            return none;
+        }
+
+        Handle h = this->freeSlots_.back();
+        this->freeSlots_.pop_back();
+
+        if ( 0 != size )
+        {
+            std::memcpy( &this->storage_[ h * this->slotSize_ ], data, size );
+        }
+
+        this->sizes_[h] = size;
+        this->refCounts_[h] = 1;
+
+        if ( this->size() > this->highWaterMark_ )
+        {
+            this->highWaterMark_ = this->size();
+        }
+
+        return h;
+    }
+
+    // Add a reference to a payload (no effect for empty payloads).
+    void addReference( Handle h )
+    {
+        if ( none != h ) ++this->refCounts_[h];
+    }
+
+    // Remove a reference to a payload, the slot is recycled with its last reference.
+    void removeReference( Handle h )
+    {
+        if ( ( none != h ) && ( 0 == --this->refCounts_[h] ) )
+        {
+            this->freeSlots_.push_back( h );
+        }
+    }
+
+    // Access a payload (nullptr and size 0 for empty payloads). The pointer stays valid
+    // as long as a reference to the payload is held.
+    fmi3Binary data( Handle h ) const
+    {
+        return ( none == h ) ? nullptr : &this->storage_[ h * this->slotSize_ ];
+    }
+
+    size_t size( Handle h ) const
+    {
+        return ( none == h ) ? 0 : this->sizes_[h];
+    }
+
+private:
+
+    std::vector<fmi3Byte> storage_;
+    size_t slotSize_;
+
+    std::vector<size_t> sizes_;
+    std::vector<uint32_t> refCounts_;
+
+    // Unused slots, the most recently freed slot is reused first.
+    std::vector<Handle> freeSlots_;
+
+    size_t highWaterMark_;
+};
+
+#endif // PayloadPool_h
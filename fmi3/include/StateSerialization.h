@@ -0,0 +1,201 @@
+/**************************************************************************
+ * Copyright (c) ERIGrid 2.0 (H2020 Programme Grant Agreement No. 870620) *
+ * All rights reserved.                                                   *
+ * See file LICENSE in the project root for license information.          *
+ **************************************************************************/
+
+#ifndef StateSerialization_h
+#define StateSerialization_h
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#include "fmi3PlatformTypes.h"
+#include "NormalGenerator.h"
+
+// Binary format of serialized FMU states (see serializeFMUState of the pipelines).
+//
+// A serialized state starts with a header (magic number, format version and the
+// instantiation token of the FMU), followed by the state of the FMU as fixed-width
+// integers and IEEE doubles in native byte order. The random generator is stored as a
+// checkpoint (see NormalGenerator). The event queue is written record by record, in an
+// order that restores it without reordering.
+//
+// Values are written directly into the importer's buffer, a writer without buffer only
+// counts bytes. Hence, the serialized size is computed by the same code that writes the
+// state.
+namespace StateSerialization
+{
+    // Magic number at the start of a serialized state ("FMUSTATE").
+    static const uint64_t magic = 0x4554415453554d46ULL;
+
+    // Version 2: random generator stored as a checkpoint (instead of the text of the
+    // standard library's engine and distribution).
+    // Version 3: checkpoints include the current engine state (uniform samples).
+    // Version 4: variables of all input and output nodes (Pipeline_configurable).
+    // Version 5: states of the burst loss models of the pipes (Pipeline_configurable).
+    // Version 6: states of the link queues of the pipes (Pipeline_configurable).
+    // Version 7: channels of the batched messages (Pipeline_deterministic).
+    // Version 8: scalar input and output clocks with per-channel flags (Pipeline_deterministic).
+    static const uint32_t version = 8;
+
+    class Writer {
+
+    public:
+
+        // Write to the given buffer (nullptr: count the bytes only).
+        Writer( fmi3Byte* data, size_t size ) : data_( data ), capacity_( size ), size_( 0 ) {}
+
+        // Number of bytes written (or counted) so far.
+        size_t size() const { return this->size_; }
+
+        // False if the buffer has been too small.
+        bool ok() const { return ( nullptr == this->data_ ) || ( this->size_ <= this->capacity_ ); }
+
+        template<typename T>
+        void put( const T& value )
+        {
+            static_assert( std::is_arithmetic<T>::value, "only numbers are serialized directly" );
+            this->putBytes( &value, sizeof( T ) );
+        }
+
+        void putString( const std::string& value )
+        {
+            this->put<uint64_t>( value.size() );
+            this->putBytes( value.data(), value.size() );
+        }
+
+        void putGenerator( const NormalGenerator& generator )
+        {
+            const NormalGenerator::Checkpoint checkpoint = generator.checkpoint();
+
+            for ( const uint64_t* words : checkpoint.engine )
+            {
+                for ( unsigned l = 0; l < NormalGenerator::lanes; ++l ) this->put( words[l] );
+            }
+
+            for ( const uint64_t* words : checkpoint.blockStart )
+            {
+                for ( unsigned l = 0; l < NormalGenerator::lanes; ++l ) this->put( words[l] );
+            }
+
+            this->put( checkpoint.position );
+        }
+
+        void putHeader( const std::string& instantiationToken )
+        {
+            this->put( magic );
+            this->put( version );
+            this->putString( instantiationToken );
+        }
+
+    private:
+
+        void putBytes( const void* bytes, size_t n )
+        {
+            if ( ( nullptr != this->data_ ) && ( this->size_ + n <= this->capacity_ ) )
+            {
+                std::memcpy( this->data_ + this->size_, bytes, n );
+            }
+
+            this->size_ += n;
+        }
+
+        fmi3Byte* data_;
+        const size_t capacity_;
+        size_t size_;
+    };
+
+    class Reader {
+
+    public:
+
+        Reader( const fmi3Byte* data, size_t size ) : data_( data ), size_( size ), pos_( 0 ), ok_( true ) {}
+
+        // False if the data has been too short or invalid.
+        bool ok() const { return this->ok_; }
+
+        // True if all bytes have been read.
+        bool atEnd() const { return this->pos_ == this->size_; }
+
+        void fail() { this->ok_ = false; }
+
+        template<typename T>
+        T get()
+        {
+            static_assert( std::is_arithmetic<T>::value, "only numbers are serialized directly" );
+
+            T value = T();
+            this->getBytes( &value, sizeof( T ) );
+            return value;
+        }
+
+        std::string getString()
+        {
+            uint64_t n = this->get<uint64_t>();
+
+            if ( ( false == this->ok_ ) || ( n > this->size_ - this->pos_ ) )
+            {
+                this->ok_ = false;
+                return std::string();
+            }
+
+            std::string value( reinterpret_cast<const char*>( this->data_ + this->pos_ ), n );
+            this->pos_ += n;
+            return value;
+        }
+
+        void getGenerator( NormalGenerator& generator )
+        {
+            NormalGenerator::Checkpoint checkpoint;
+
+            for ( uint64_t* words : checkpoint.engine )
+            {
+                for ( unsigned l = 0; l < NormalGenerator::lanes; ++l ) words[l] = this->get<uint64_t>();
+            }
+
+            for ( uint64_t* words : checkpoint.blockStart )
+            {
+                for ( unsigned l = 0; l < NormalGenerator::lanes; ++l ) words[l] = this->get<uint64_t>();
+            }
+
+            checkpoint.position = this->get<uint32_t>();
+
+            if ( ( false == this->ok_ ) || ( false == generator.restore( checkpoint ) ) ) this->ok_ = false;
+        }
+
+        // Check the header (magic number, format version and instantiation token).
+        bool getHeader( const std::string& instantiationToken )
+        {
+            if ( magic != this->get<uint64_t>() ) this->ok_ = false;
+            if ( version != this->get<uint32_t>() ) this->ok_ = false;
+            if ( instantiationToken != this->getString() ) this->ok_ = false;
+
+            return this->ok_;
+        }
+
+    private:
+
+        void getBytes( void* bytes, size_t n )
+        {
+            if ( ( false == this->ok_ ) || ( n > this->size_ - this->pos_ ) )
+            {
+                this->ok_ = false;
+                return;
+            }
+
+            std::memcpy( bytes, this->data_ + this->pos_, n );
+            this->pos_ += n;
+        }
+
+        const fmi3Byte* data_;
+        const size_t size_;
+        size_t pos_;
+        bool ok_;
+    };
+}
+
+#endif // StateSerialization_h
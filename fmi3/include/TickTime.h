@@ -0,0 +1,47 @@
+/**************************************************************************
+ * Copyright (c) ERIGrid 2.0 (H2020 Programme Grant Agreement No. 870620) *
+ * All rights reserved.                                                   *
+ * See file LICENSE in the project root for license information.          *
+ **************************************************************************/
+
+#ifndef TickTime_h
+#define TickTime_h
+
+#include <cmath>
+#include <limits>
+
+#include "fmi3PlatformTypes.h"
+
+// Internal time base of the pipeline FMUs.
+//
+// Internally, all points in time are integer multiples of a tick, whose duration is
+// defined by the number of ticks per second. Ticks can be compared exactly, hence no
+// tolerances are needed for ordering events. Floating point values (in seconds) are
+// only used at the FMI interface.
+namespace TickTime
+{
+    typedef fmi3Int64 Ticks;
+
+    // Placeholder for "no point in time" (e.g., no next event).
+    static const Ticks never = std::numeric_limits<Ticks>::max();
+
+    // Convert from seconds to the nearest number of ticks.
+    inline Ticks fromSeconds( fmi3Float64 t, fmi3Int64 ticksPerSecond )
+    {
+        return static_cast<Ticks>( std::llround( t * ticksPerSecond ) );
+    }
+
+    // Convert from seconds to the number of complete ticks (rounding down).
+    inline Ticks fromSecondsFloor( fmi3Float64 t, fmi3Int64 ticksPerSecond )
+    {
+        return static_cast<Ticks>( std::floor( t * ticksPerSecond ) );
+    }
+
+    // Convert from ticks to seconds.
+    inline fmi3Float64 toSeconds( Ticks t, fmi3Int64 ticksPerSecond )
+    {
+        return static_cast<fmi3Float64>( t ) / ticksPerSecond;
+    }
+}
+
+#endif // TickTime_h
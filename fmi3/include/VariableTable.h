@@ -0,0 +1,137 @@
+/**************************************************************************
+ * Copyright (c) ERIGrid 2.0 (H2020 Programme Grant Agreement No. 870620) *
+ * All rights reserved.                                                   *
+ * See file LICENSE in the project root for license information.          *
+ **************************************************************************/
+
+#ifndef VariableTable_h
+#define VariableTable_h
+
+#include <cstddef>
+#include <vector>
+
+#include "fmi3PlatformTypes.h"
+
+// Causality of a variable, as declared in FMI3.xml.
+enum VariableCausality {
+    parameterVariable,
+    structuralParameterVariable,
+    inputVariable,
+    outputVariable
+};
+
+// Compile-time description of a variable of type T: its value reference, the member of
+// the FMU class that holds its value and its causality. Array variables are held in
+// members of type std::vector<T> (the dimension is the size of the vector).
+template<typename Instance, typename T>
+struct VariableDescription {
+    fmi3ValueReference valueReference;
+    T Instance::* scalar;
+    std::vector<T> Instance::* array;
+    VariableCausality causality;
+};
+
+template<typename Instance, typename T>
+constexpr VariableDescription<Instance, T> scalarVariable(
+    fmi3ValueReference valueReference,
+    T Instance::* member,
+    VariableCausality causality
+) {
+    return VariableDescription<Instance, T>{ valueReference, member, nullptr, causality };
+}
+
+template<typename Instance, typename T>
+constexpr VariableDescription<Instance, T> arrayVariable(
+    fmi3ValueReference valueReference,
+    std::vector<T> Instance::* member,
+    VariableCausality causality
+) {
+    return VariableDescription<Instance, T>{ valueReference, nullptr, member, causality };
+}
+
+// Check that the value references of a description table are strictly increasing, i.e.,
+// sorted and unique. Intended for static assertions on the FMU's tables, which have to
+// list the variables in the same order as FMI3.xml.
+template<typename Instance, typename T, size_t N>
+constexpr bool hasIncreasingValueReferences( const VariableDescription<Instance, T> ( &variables )[N] )
+{
+    for ( size_t i = 1; i < N; ++i )
+    {
+        if ( variables[i - 1].valueReference >= variables[i].valueReference ) return false;
+    }
+
+    return true;
+}
+
+// Lookup table from value references to the variables of type T of an FMU instance.
+//
+// The table is bound to an instance from its description table, variables that depend
+// on the configuration of an instance are added one by one. Entries are stored
+// densely, indexed by the value reference relative to the smallest one, hence a lookup
+// is a single bounds check and an indexed load.
+template<typename T>
+class VariableTable {
+
+public:
+
+    struct Entry {
+        T* scalar;
+        std::vector<T>* array;
+        VariableCausality causality;
+    };
+
+    VariableTable() : first_( 0 ) {}
+
+    template<typename Instance, size_t N>
+    void bind( Instance* instance, const VariableDescription<Instance, T> ( &variables )[N] )
+    {
+        this->first_ = variables[0].valueReference;
+        this->entries_.assign( variables[N - 1].valueReference - this->first_ + 1, Entry() );
+
+        for ( size_t i = 0; i < N; ++i )
+        {
+            Entry& entry = this->entries_[ variables[i].valueReference - this->first_ ];
+            entry.scalar = variables[i].scalar ? &( instance->*variables[i].scalar ) : nullptr;
+            entry.array = variables[i].array ? &( instance->*variables[i].array ) : nullptr;
+            entry.causality = variables[i].causality;
+        }
+    }
+
+    // Add a scalar variable that is only known at run time (e.g., from a configuration
+    // file of the FMU), after bind. The table grows as needed.
+    void add( fmi3ValueReference valueReference, T* scalar, VariableCausality causality )
+    {
+        if ( this->entries_.empty() )
+        {
+            this->first_ = valueReference;
+        }
+        else if ( valueReference < this->first_ )
+        {
+            this->entries_.insert( this->entries_.begin(), this->first_ - valueReference, Entry() );
+            this->first_ = valueReference;
+        }
+
+        const size_t i = valueReference - this->first_;
+        if ( i >= this->entries_.size() ) this->entries_.resize( i + 1, Entry() );
+
+        this->entries_[i] = Entry{ scalar, nullptr, causality };
+    }
+
+    // Find a variable (nullptr if the value reference is unknown).
+    const Entry* find( fmi3ValueReference valueReference ) const
+    {
+        size_t i = static_cast<size_t>( valueReference - this->first_ );
+
+        if ( ( valueReference < this->first_ ) || ( i >= this->entries_.size() ) ) return nullptr;
+
+        const Entry& entry = this->entries_[i];
+        return ( entry.scalar || entry.array ) ? &entry : nullptr;
+    }
+
+private:
+
+    fmi3ValueReference first_;
+    std::vector<Entry> entries_;
+};
+
+#endif // VariableTable_h
@@ -0,0 +1,163 @@
+/**************************************************************************
+ * Copyright (c) ERIGrid 2.0 (H2020 Programme Grant Agreement No. 870620) *
+ * All rights reserved.                                                   *
+ * See file LICENSE in the project root for license information.          *
+ **************************************************************************/
+
+#include "AsyncLogger.h"
+
+AsyncLogger::AsyncLogger(
+    fmi3LogMessageCallback callback,
+    fmi3InstanceEnvironment instanceEnvironment,
+    const std::string& instanceName,
+    FILE* file
+) :
+    callback_( callback ),
+    instanceEnvironment_( instanceEnvironment ),
+    instanceName_( instanceName ),
+    file_( file ),
+    buffer_( new SpscEventRingBuffer<Record>( capacity ) ),
+    dropped_( 0 ),
+    waiting_( false ),
+    reported_( 0 ),
+    stopping_( false ),
+    thread_( &AsyncLogger::run, this )
+{}
+
+AsyncLogger::~AsyncLogger()
+{
+    {
+        std::lock_guard<std::mutex> lock( this->mutex_ );
+        this->stopping_ = true;
+    }
+
+    this->wakeUp_.notify_one();
+    this->thread_.join();
+
+    this->flush();
+}
+
+void
+AsyncLogger::log(
+    fmi3Status status,
+    const char* category,
+    const char* message,
+    va_list args
+) {
+    // Warnings and errors are not deferred, they are written after the pending messages.
+    if ( fmi3Warning <= status )
+    {
+        char text[maxMessageLength];
+        vsnprintf( text, maxMessageLength, message, args );
+
+        std::lock_guard<std::mutex> lock( this->mutex_ );
+        this->drain();
+        this->write( status, category, text );
+
+        if ( nullptr == this->callback_ )
+        {
+            fflush( this->file_ );
+        }
+
+        return;
+    }
+
+    Record record;
+    record.status = status;
+    record.category = category;
+    vsnprintf( record.message, maxMessageLength, message, args );
+
+    if ( false == this->buffer_->push( record ) )
+    {
+        this->dropped_.fetch_add( 1, std::memory_order_relaxed );
+    }
+
+    // Either the background thread sees the new record before it waits, or this thread sees
+    // that it waits (see run). The mutex ensures that the notification is not lost between
+    // checking the buffer and waiting.
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    if ( this->waiting_.load( std::memory_order_relaxed ) )
+    {
+        std::lock_guard<std::mutex> lock( this->mutex_ );
+        this->wakeUp_.notify_one();
+    }
+}
+
+void
+AsyncLogger::flush()
+{
+    std::lock_guard<std::mutex> lock( this->mutex_ );
+    this->drain();
+
+    if ( nullptr == this->callback_ )
+    {
+        fflush( this->file_ );
+    }
+}
+
+void
+AsyncLogger::run()
+{
+    std::unique_lock<std::mutex> lock( this->mutex_ );
+
+    while ( true )
+    {
+        this->drain();
+
+        if ( this->stopping_ )
+        {
+            break;
+        }
+
+        this->waiting_.store( true, std::memory_order_relaxed );
+        std::atomic_thread_fence( std::memory_order_seq_cst );
+
+        if ( this->buffer_->empty() )
+        {
+            this->wakeUp_.wait( lock );
+        }
+
+        this->waiting_.store( false, std::memory_order_relaxed );
+    }
+}
+
+void
+AsyncLogger::drain()
+{
+    while ( false == this->buffer_->empty() )
+    {
+        const Record& record = this->buffer_->front();
+        this->write( record.status, record.category, record.message );
+        this->buffer_->pop();
+    }
+
+    uint64_t dropped = this->dropped_.load( std::memory_order_relaxed );
+
+    if ( dropped != this->reported_ )
+    {
+        char message[maxMessageLength];
+        snprintf(
+            message, maxMessageLength, "%llu log messages dropped (buffer overflow)",
+            static_cast<unsigned long long>( dropped - this->reported_ )
+        );
+
+        this->write( fmi3Warning, "WARNING", message );
+        this->reported_ = dropped;
+    }
+}
+
+void
+AsyncLogger::write(
+    fmi3Status status,
+    const char* category,
+    const char* message
+) {
+    if ( nullptr != this->callback_ )
+    {
+        this->callback_( this->instanceEnvironment_, status, category, message );
+    }
+    else
+    {
+        fprintf( this->file_, "=== [%s] %s/%s\n", category, this->instanceName_.c_str(), message );
+    }
+}
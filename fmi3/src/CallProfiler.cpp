@@ -0,0 +1,159 @@
+/**************************************************************************
+ * Copyright (c) ERIGrid 2.0 (H2020 Programme Grant Agreement No. 870620) *
+ * All rights reserved.                                                   *
+ * See file LICENSE in the project root for license information.          *
+ **************************************************************************/
+
+#include "CallProfiler.h"
+
+#include <algorithm>
+#include <mutex>
+
+namespace
+{
+    // Names of the registered FMI functions, indexed by call ID.
+    std::mutex& registryMutex()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    std::vector<const char*>& registry()
+    {
+        static std::vector<const char*> names;
+        return names;
+    }
+
+    // Percentiles written for each function.
+    const double percentiles[] = { .5, .9, .99, .999 };
+    const char* const percentileNames[] = { "50", "90", "99", "99.9" };
+}
+
+size_t
+LatencyHistogram::bucketIndex( uint64_t value )
+{
+    if ( value < subBuckets ) return static_cast<size_t>( value );
+
+    unsigned exponent = 63;
+    while ( 0 == ( value >> exponent ) ) --exponent;
+
+    unsigned shift = exponent - subBucketBits;
+    return ( shift + 1 ) * subBuckets + static_cast<size_t>( ( value >> shift ) & ( subBuckets - 1 ) );
+}
+
+uint64_t
+LatencyHistogram::bucketLowerBound( size_t i )
+{
+    if ( i < subBuckets ) return i;
+
+    unsigned shift = static_cast<unsigned>( i / subBuckets ) - 1;
+    return static_cast<uint64_t>( subBuckets + i % subBuckets ) << shift;
+}
+
+uint64_t
+LatencyHistogram::bucketUpperBound( size_t i )
+{
+    if ( i < subBuckets ) return i;
+
+    unsigned shift = static_cast<unsigned>( i / subBuckets ) - 1;
+    return bucketLowerBound( i ) + ( ( uint64_t( 1 ) << shift ) - 1 );
+}
+
+uint64_t
+LatencyHistogram::percentile( double fraction ) const
+{
+    uint64_t rank = static_cast<uint64_t>( fraction * this->count_ + .5 );
+    uint64_t seen = 0;
+
+    for ( size_t i = 0; i < buckets; ++i )
+    {
+        seen += this->counts_[i];
+        if ( ( seen >= rank ) && ( 0 != seen ) )
+        {
+            return std::min( bucketUpperBound( i ), this->max_ );
+        }
+    }
+
+    return this->max_;
+}
+
+size_t
+CallProfiler::registerCall( const char* name )
+{
+    std::lock_guard<std::mutex> lock( registryMutex() );
+    registry().push_back( name );
+    return registry().size() - 1;
+}
+
+CallProfiler::CallProfiler() :
+    startTicks_( now() ),
+    startTime_( std::chrono::steady_clock::now() )
+{}
+
+double
+CallProfiler::ticksPerNanosecond() const
+{
+    double elapsed = std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - this->startTime_ ).count();
+    uint64_t ticks = now() - this->startTicks_;
+
+    return ( ( elapsed > 0. ) && ( 0 != ticks ) ) ? ticks / elapsed : 1.;
+}
+
+void
+CallProfiler::writeJson( FILE* file, const char* instanceName ) const
+{
+    const double scale = 1. / this->ticksPerNanosecond();
+
+    std::vector<const char*> names;
+    {
+        std::lock_guard<std::mutex> lock( registryMutex() );
+        names = registry();
+    }
+
+    fprintf( file, "{\n  \"instance\": \"%s\",\n", instanceName );
+    fprintf( file, "  \"ticksPerNanosecond\": %.6f,\n", 1. / scale );
+    fprintf( file, "  \"calls\": [" );
+
+    bool first = true;
+
+    for ( size_t id = 0; id < this->histograms_.size(); ++id )
+    {
+        const LatencyHistogram* h = this->histograms_[id].get();
+        if ( nullptr == h ) continue;
+
+        fprintf( file, "%s\n    {\n      \"function\": \"%s\",\n", first ? "" : ",", names[id] );
+        fprintf( file, "      \"count\": %llu,\n", static_cast<unsigned long long>( h->count() ) );
+        fprintf( file, "      \"totalNs\": %.1f,\n", h->total() * scale );
+        fprintf( file, "      \"minNs\": %.1f,\n", h->min() * scale );
+        fprintf( file, "      \"meanNs\": %.1f,\n", h->total() * scale / h->count() );
+        fprintf( file, "      \"maxNs\": %.1f,\n", h->max() * scale );
+
+        fprintf( file, "      \"percentilesNs\": {" );
+        for ( size_t p = 0; p < sizeof( percentiles ) / sizeof( percentiles[0] ); ++p )
+        {
+            fprintf( file, "%s \"%s\": %.1f", ( 0 == p ) ? "" : ",", percentileNames[p], h->percentile( percentiles[p] ) * scale );
+        }
+        fprintf( file, " },\n" );
+
+        // Non-empty buckets as [lower bound (ns), upper bound (ns), count].
+        fprintf( file, "      \"histogram\": [" );
+        bool firstBucket = true;
+        for ( size_t i = 0; i < LatencyHistogram::buckets; ++i )
+        {
+            if ( 0 == h->bucketCount( i ) ) continue;
+
+            fprintf(
+                file, "%s [%.1f, %.1f, %llu]", firstBucket ? "" : ",",
+                LatencyHistogram::bucketLowerBound( i ) * scale,
+                LatencyHistogram::bucketUpperBound( i ) * scale,
+                static_cast<unsigned long long>( h->bucketCount( i ) )
+            );
+            firstBucket = false;
+        }
+        fprintf( file, " ]\n    }" );
+
+        first = false;
+    }
+
+    fprintf( file, "\n  ]\n}\n" );
+}
@@ -0,0 +1,173 @@
+/**************************************************************************
+ * Copyright (c) ERIGrid 2.0 (H2020 Programme Grant Agreement No. 870620) *
+ * All rights reserved.                                                   *
+ * See file LICENSE in the project root for license information.          *
+ **************************************************************************/
+
+#include "EmpiricalDistribution.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+
+namespace
+{
+    // Split a line into numbers (separated by whitespace or commas). Returns false if a
+    // field is not a number.
+    bool parseLine( const std::string& line, std::vector<double>& values )
+    {
+        values.clear();
+
+        const char* p = line.c_str();
+        while ( true )
+        {
+            while ( ( ' ' == *p ) || ( '\t' == *p ) || ( ',' == *p ) || ( '\r' == *p ) ) ++p;
+            if ( '\0' == *p ) return true;
+
+            char* end;
+            double value = std::strtod( p, &end );
+            if ( ( end == p ) || ( false == std::isfinite( value ) ) ) return false;
+
+            values.push_back( value );
+            p = end;
+        }
+    }
+}
+
+bool
+EmpiricalDistribution::load( const std::string& path, std::string& error )
+{
+    std::ifstream file( path.c_str() );
+    if ( false == file.good() )
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    // Bins (lower bound, upper bound, weight).
+    std::vector<double> lower;
+    std::vector<double> upper;
+    std::vector<double> weight;
+
+    std::string line;
+    std::vector<double> values;
+    size_t columns = 0;
+    size_t lineNumber = 0;
+    double lastDelay = 0.;
+    double lastProbability = 0.;
+
+    while ( std::getline( file, line ) )
+    {
+        ++lineNumber;
+
+        size_t first = line.find_first_not_of( " \t\r" );
+        if ( ( std::string::npos == first ) || ( '#' == line[first] ) ) continue;
+
+        if ( false == parseLine( line, values ) )
+        {
+            error = path + ", line " + std::to_string( lineNumber ) + ": invalid number";
+            return false;
+        }
+
+        if ( 0 == columns ) columns = values.size();
+
+        if ( ( values.size() != columns ) || ( ( 2 != columns ) && ( 3 != columns ) ) )
+        {
+            error = path + ", line " + std::to_string( lineNumber ) + ": expected 2 (CDF) or 3 (histogram) values";
+            return false;
+        }
+
+        if ( 3 == columns )
+        {
+            // Histogram bin.
+            if ( ( 0. > values[0] ) || ( values[1] < values[0] ) || ( 0. > values[2] ) )
+            {
+                error = path + ", line " + std::to_string( lineNumber ) + ": invalid bin";
+                return false;
+            }
+
+            lower.push_back( values[0] );
+            upper.push_back( values[1] );
+            weight.push_back( values[2] );
+        }
+        else
+        {
+            // CDF point, the probability between the previous point and this one is spread
+            // uniformly (the first point is a bin of width 0).
+            const bool firstPoint = lower.empty();
+
+            if ( ( 0. > values[0] ) || ( 0. > values[1] ) ||
+                 ( false == firstPoint && ( ( values[0] < lastDelay ) || ( values[1] < lastProbability ) ) ) )
+            {
+                error = path + ", line " + std::to_string( lineNumber ) + ": CDF must be non-decreasing";
+                return false;
+            }
+
+            lower.push_back( firstPoint ? values[0] : lastDelay );
+            upper.push_back( values[0] );
+            weight.push_back( values[1] - ( firstPoint ? 0. : lastProbability ) );
+
+            lastDelay = values[0];
+            lastProbability = values[1];
+        }
+    }
+
+    double total = 0.;
+    for ( double w : weight ) total += w;
+
+    if ( ( false == ( 0. < total ) ) || ( weight.size() > std::numeric_limits<uint32_t>::max() ) )
+    {
+        error = path + ": empty distribution";
+        return false;
+    }
+
+    // Alias table (Vose): bins are split into those with less and those with more than the
+    // average probability. Each small bin is filled up with probability of a large one,
+    // which becomes its alias.
+    const size_t n = weight.size();
+    std::vector<Bin> bins( n );
+    std::vector<double> scaled( n );
+    std::vector<uint32_t> small;
+    std::vector<uint32_t> large;
+    double mean = 0.;
+
+    for ( size_t i = 0; i < n; ++i )
+    {
+        bins[i].lower = lower[i];
+        bins[i].width = upper[i] - lower[i];
+        bins[i].threshold = 1.;
+        bins[i].alias = static_cast<uint32_t>( i );
+
+        scaled[i] = weight[i] * n / total;
+        ( ( scaled[i] < 1. ) ? small : large ).push_back( static_cast<uint32_t>( i ) );
+
+        mean += weight[i] / total * ( lower[i] + .5 * bins[i].width );
+    }
+
+    while ( ( false == small.empty() ) && ( false == large.empty() ) )
+    {
+        const uint32_t s = small.back();
+        const uint32_t l = large.back();
+        small.pop_back();
+
+        bins[s].threshold = scaled[s];
+        bins[s].alias = l;
+
+        scaled[l] -= 1. - scaled[s];
+        if ( scaled[l] < 1. )
+        {
+            large.pop_back();
+            small.push_back( l );
+        }
+    }
+
+    // The remaining bins are full (up to rounding errors).
+    for ( uint32_t i : small ) bins[i].threshold = 1.;
+    for ( uint32_t i : large ) bins[i].threshold = 1.;
+
+    this->bins_.swap( bins );
+    this->mean_ = mean;
+
+    return true;
+}
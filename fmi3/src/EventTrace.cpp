@@ -0,0 +1,116 @@
+/**************************************************************************
+ * Copyright (c) ERIGrid 2.0 (H2020 Programme Grant Agreement No. 870620) *
+ * All rights reserved.                                                   *
+ * See file LICENSE in the project root for license information.          *
+ **************************************************************************/
+
+#include "EventTrace.h"
+
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace EventTraceFormat;
+
+namespace
+{
+    // Create a file of the given size and map it into memory (nullptr on failure).
+    void* mapFile( const std::string& path, size_t size )
+    {
+#ifdef _WIN32
+        HANDLE file = CreateFileA(
+            path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL
+        );
+        if ( INVALID_HANDLE_VALUE == file ) return nullptr;
+
+        HANDLE mapping = CreateFileMappingA(
+            file, NULL, PAGE_READWRITE,
+            static_cast<DWORD>( static_cast<uint64_t>( size ) >> 32 ), static_cast<DWORD>( size & 0xFFFFFFFFu ), NULL
+        );
+        CloseHandle( file );
+        if ( NULL == mapping ) return nullptr;
+
+        void* data = MapViewOfFile( mapping, FILE_MAP_WRITE, 0, 0, size );
+        CloseHandle( mapping );
+        return data;
+#else
+        int fd = ::open( path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644 );
+        if ( -1 == fd ) return nullptr;
+
+        if ( 0 != ::ftruncate( fd, static_cast<off_t>( size ) ) )
+        {
+            ::close( fd );
+            return nullptr;
+        }
+
+        void* data = ::mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+        ::close( fd );
+        return ( MAP_FAILED == data ) ? nullptr : data;
+#endif
+    }
+
+    void unmapFile( void* data, size_t size )
+    {
+#ifdef _WIN32
+        FlushViewOfFile( data, size );
+        UnmapViewOfFile( data );
+#else
+        ::msync( data, size, MS_ASYNC );
+        ::munmap( data, size );
+#endif
+    }
+}
+
+bool
+EventTrace::open(
+    const std::string& path,
+    size_t capacity,
+    int64_t ticksPerSecond
+) {
+    this->close();
+
+    if ( 0 == capacity ) return false;
+
+    size_t size = sizeof( Header ) + capacity * sizeof( Record );
+    void* mapping = mapFile( path, size );
+
+    if ( nullptr == mapping ) return false;
+
+    // The file is created with zeros, i.e., all records are unused.
+    this->header_ = static_cast<Header*>( mapping );
+    std::memset( this->header_, 0, sizeof( Header ) );
+    this->header_->magic = magic;
+    this->header_->version = version;
+    this->header_->recordSize = sizeof( Record );
+    this->header_->capacity = capacity;
+    this->header_->ticksPerSecond = ticksPerSecond;
+
+    this->records_ = reinterpret_cast<Record*>( static_cast<char*>( mapping ) + sizeof( Header ) );
+    this->capacity_ = capacity;
+    this->count_ = 0;
+    this->mapping_ = mapping;
+    this->mappingSize_ = size;
+
+    return true;
+}
+
+void
+EventTrace::close()
+{
+    if ( nullptr == this->mapping_ ) return;
+
+    unmapFile( this->mapping_, this->mappingSize_ );
+
+    this->header_ = nullptr;
+    this->records_ = nullptr;
+    this->capacity_ = 0;
+    this->count_ = 0;
+    this->mapping_ = nullptr;
+    this->mappingSize_ = 0;
+}
@@ -6,8 +6,11 @@
 
 #include "InstanceBase.h"
 
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+
 #include "fmi3FunctionTypes.h"
-#include <iostream>
 
 #include "FMUMode.h"
 
@@ -34,7 +37,7 @@ InstanceBase::InstanceBase(
     instantiationToken_( instantiationToken ),
     resourceLocation_( resourceLocation ),
     visible_( visible ),
-    loggingOn_( loggingOn ),
+    debugLogCategories_( ( fmi3True == loggingOn ) ? allLogCategories : 0 ),
     eventModeUsed_( eventModeUsed ),
     earlyReturnAllowed_( earlyReturnAllowed ),
     requiredIntermediateVariables_(
@@ -44,13 +47,14 @@ InstanceBase::InstanceBase(
     instanceEnvironment_( instanceEnvironment ),
     logger_( logMessage ),
     intermediateUpdate_( intermediateUpdate ),
+    log_( logMessage, instanceEnvironment, instanceName ),
     mode_( instantiated )
 {
-    this->logDebug( "instantiationToken = %s", this->instantiationToken_.c_str() );
-    this->logDebug( "resourceLocation = %s", this->resourceLocation_.c_str() );
-    this->logDebug( "visible = %d", this->visible_ );
-    this->logDebug( "eventModeUsed = %d", this->eventModeUsed_ );
-    this->logDebug( "earlyReturnAllowed = %d", this->earlyReturnAllowed_ );
+    this->logDebug( logInstance, "instantiationToken = %s", this->instantiationToken_.c_str() );
+    this->logDebug( logInstance, "resourceLocation = %s", this->resourceLocation_.c_str() );
+    this->logDebug( logInstance, "visible = %d", this->visible_ );
+    this->logDebug( logInstance, "eventModeUsed = %d", this->eventModeUsed_ );
+    this->logDebug( logInstance, "earlyReturnAllowed = %d", this->earlyReturnAllowed_ );
 }
 
 fmi3Status
@@ -59,7 +63,33 @@ InstanceBase::setDebugLogging(
     size_t nCategories,
     const fmi3String categories[]
 ) {
-    NOT_IMPLEMENTED
+    // Without categories, the setting applies to all categories.
+    unsigned mask = ( 0 == nCategories ) ? allLogCategories : 0;
+
+    for ( size_t i = 0; i < nCategories; ++i )
+    {
+        LogCategory category;
+
+        if ( false == findLogCategory( categories[i], category ) )
+        {
+            this->logError( "Unknown log category: %s", categories[i] );
+            return fmi3Error;
+        }
+
+        mask |= category;
+    }
+
+    // Logging on enables exactly the given categories, logging off disables them.
+    if ( fmi3True == loggingOn )
+    {
+        this->debugLogCategories_ = mask;
+    }
+    else
+    {
+        this->debugLogCategories_ &= ~mask;
+    }
+
+    return fmi3OK;
 }
 
 fmi3Status
@@ -92,6 +122,9 @@ fmi3Status
 InstanceBase::terminate()
 {
     this->mode_ = terminated;
+
+    // Make sure all messages have been passed to the importer.
+    this->log_.flush();
     return fmi3OK;
 }
 
@@ -110,7 +143,7 @@ InstanceBase::getFloat32(
     fmi3Float32 values[],
     size_t nValues
 ) {
-    NOT_IMPLEMENTED
+    return this->getVariables( this->float32Table_, valueReferences, nValueReferences, values, nValues );
 }
 
 fmi3Status
@@ -120,7 +153,7 @@ InstanceBase::getFloat64(
     fmi3Float64 values[],
     size_t nValues
 ) {
-    NOT_IMPLEMENTED
+    return this->getVariables( this->float64Table_, valueReferences, nValueReferences, values, nValues );
 }
 
 fmi3Status
@@ -130,7 +163,7 @@ InstanceBase::getInt8(
     fmi3Int8 values[],
     size_t nValues
 ) {
-    NOT_IMPLEMENTED
+    return this->getVariables( this->int8Table_, valueReferences, nValueReferences, values, nValues );
 }
 
 fmi3Status
@@ -140,7 +173,7 @@ InstanceBase::getUInt8(
     fmi3UInt8 values[],
     size_t nValues
 ) {
-    NOT_IMPLEMENTED
+    return this->getVariables( this->uInt8Table_, valueReferences, nValueReferences, values, nValues );
 }
 
 fmi3Status
@@ -150,7 +183,7 @@ InstanceBase::getInt16(
     fmi3Int16 values[],
     size_t nValues
 ) {
-    NOT_IMPLEMENTED
+    return this->getVariables( this->int16Table_, valueReferences, nValueReferences, values, nValues );
 }
 
 fmi3Status
@@ -160,7 +193,7 @@ InstanceBase::getUInt16(
     fmi3UInt16 values[],
     size_t nValues
 ) {
-    NOT_IMPLEMENTED
+    return this->getVariables( this->uInt16Table_, valueReferences, nValueReferences, values, nValues );
 }
 
 fmi3Status
@@ -170,7 +203,7 @@ InstanceBase::getInt32(
     fmi3Int32 values[],
     size_t nValues
 ) {
-    NOT_IMPLEMENTED
+    return this->getVariables( this->int32Table_, valueReferences, nValueReferences, values, nValues );
 }
 
 fmi3Status
@@ -180,7 +213,7 @@ InstanceBase::getUInt32(
     fmi3UInt32 values[],
     size_t nValues
 ) {
-    NOT_IMPLEMENTED
+    return this->getVariables( this->uInt32Table_, valueReferences, nValueReferences, values, nValues );
 }
 
 fmi3Status
@@ -190,7 +223,7 @@ InstanceBase::getInt64(
     fmi3Int64 values[],
     size_t nValues
 ) {
-    NOT_IMPLEMENTED
+    return this->getVariables( this->int64Table_, valueReferences, nValueReferences, values, nValues );
 }
 
 fmi3Status
@@ -200,7 +233,7 @@ InstanceBase::getUInt64(
     fmi3UInt64 values[],
     size_t nValues
 ) {
-    NOT_IMPLEMENTED
+    return this->getVariables( this->uInt64Table_, valueReferences, nValueReferences, values, nValues );
 }
 
 fmi3Status
@@ -210,7 +243,7 @@ InstanceBase::getBoolean(
     fmi3Boolean values[],
     size_t nValues
 ) {
-    NOT_IMPLEMENTED
+    return this->getVariables( this->booleanTable_, valueReferences, nValueReferences, values, nValues );
 }
 
 fmi3Status
@@ -220,7 +253,7 @@ InstanceBase::getString (
     fmi3String values[],
     size_t nValues
 ) {
-    NOT_IMPLEMENTED
+    return this->getVariables( this->stringTable_, valueReferences, nValueReferences, values, nValues );
 }
 
 fmi3Status
@@ -240,7 +273,10 @@ InstanceBase::getClock(
     size_t nValueReferences,
     fmi3Clock values[]
 ) {
-    NOT_IMPLEMENTED
+    // Clocks are scalar variables, there is exactly one value per value reference.
+    return this->getVariables(
+        this->clockTable_, valueReferences, nValueReferences, values, nValueReferences
+    );
 }
 
 fmi3Status
@@ -250,7 +286,7 @@ InstanceBase::setFloat32(
     const fmi3Float32 values[],
     size_t nValues
 ) {
-    NOT_IMPLEMENTED
+    return this->setVariables( this->float32Table_, valueReferences, nValueReferences, values, nValues );
 }
 
 fmi3Status
@@ -260,7 +296,7 @@ InstanceBase::setFloat64(
     const fmi3Float64 values[],
     size_t nValues
 ) {
-    NOT_IMPLEMENTED
+    return this->setVariables( this->float64Table_, valueReferences, nValueReferences, values, nValues );
 }
 
 fmi3Status
@@ -270,7 +306,7 @@ InstanceBase::setInt8(
     const fmi3Int8 values[],
     size_t nValues
 ) {
-    NOT_IMPLEMENTED
+    return this->setVariables( this->int8Table_, valueReferences, nValueReferences, values, nValues );
 }
 
 fmi3Status
@@ -280,7 +316,7 @@ InstanceBase::setUInt8(
     const fmi3UInt8 values[],
     size_t nValues
 ) {
-    NOT_IMPLEMENTED
+    return this->setVariables( this->uInt8Table_, valueReferences, nValueReferences, values, nValues );
 }
 
 fmi3Status
@@ -290,7 +326,7 @@ InstanceBase::setInt16(
     const fmi3Int16 values[],
     size_t nValues
 ) {
-    NOT_IMPLEMENTED
+    return this->setVariables( this->int16Table_, valueReferences, nValueReferences, values, nValues );
 }
 
 fmi3Status
@@ -300,7 +336,7 @@ InstanceBase::setUInt16(
     const fmi3UInt16 values[],
     size_t nValues
 ) {
-    NOT_IMPLEMENTED
+    return this->setVariables( this->uInt16Table_, valueReferences, nValueReferences, values, nValues );
 }
 
 fmi3Status
@@ -310,7 +346,7 @@ InstanceBase::setInt32(
     const fmi3Int32 values[],
     size_t nValues
 ) {
-    NOT_IMPLEMENTED
+    return this->setVariables( this->int32Table_, valueReferences, nValueReferences, values, nValues );
 }
 
 fmi3Status
@@ -320,7 +356,7 @@ InstanceBase::setUInt32(
     const fmi3UInt32 values[],
     size_t nValues
 ) {
-    NOT_IMPLEMENTED
+    return this->setVariables( this->uInt32Table_, valueReferences, nValueReferences, values, nValues );
 }
 
 fmi3Status
@@ -330,7 +366,7 @@ InstanceBase::setInt64(
     const fmi3Int64 values[],
     size_t nValues
 ) {
-    NOT_IMPLEMENTED
+    return this->setVariables( this->int64Table_, valueReferences, nValueReferences, values, nValues );
 }
 
 fmi3Status
@@ -340,7 +376,7 @@ InstanceBase::setUInt64(
     const fmi3UInt64 values[],
     size_t nValues
 ) {
-    NOT_IMPLEMENTED
+    return this->setVariables( this->uInt64Table_, valueReferences, nValueReferences, values, nValues );
 }
 
 fmi3Status
@@ -350,7 +386,7 @@ InstanceBase::setBoolean(
     const fmi3Boolean values[],
     size_t nValues
 ) {
-    NOT_IMPLEMENTED
+    return this->setVariables( this->booleanTable_, valueReferences, nValueReferences, values, nValues );
 }
 
 fmi3Status
@@ -360,7 +396,7 @@ InstanceBase::setString(
     const fmi3String values[],
     size_t nValues
 ) {
-    NOT_IMPLEMENTED
+    return this->setVariables( this->stringTable_, valueReferences, nValueReferences, values, nValues );
 }
 
 fmi3Status
@@ -380,7 +416,21 @@ InstanceBase::setClock(
     size_t nValueReferences,
     const fmi3Clock values[]
 ) {
-    NOT_IMPLEMENTED
+    // Input clocks are activated by the importer. They are only deactivated by the FMU
+    // itself, after the event has been handled. Clocks are scalar variables, hence every
+    // value that is set is checked.
+    for ( size_t i = 0; i < nValueReferences; ++i )
+    {
+        if ( fmi3ClockInactive == values[i] )
+        {
+            this->logError( "clocks may not be deactivated by the importer" );
+            return fmi3Error;
+        }
+    }
+
+    return this->setVariables(
+        this->clockTable_, valueReferences, nValueReferences, values, nValueReferences
+    );
 }
 
 /* Getting Variable Dependency Information */
@@ -607,38 +657,19 @@ InstanceBase::logMessage(
     const char *message,
     va_list args
 ) {
-    va_list args1;
-    size_t len = 0;
-    char* buf = new char;
-
-    va_copy( args1, args );
-    len = vsnprintf( buf, len, message, args1 );
-    va_end( args1 );
-
-    va_copy( args1, args );
-    buf = ( char* ) calloc( len + 1, sizeof( char ) );
-    vsnprintf( buf, len + 1, message, args );
-    va_end( args1 );
-
-    std::cout << "=== [" << category << "] " << instanceName_ << "/" << buf << std::endl;
-
-/*    this->logger_(
-        this->instanceEnvironment_, this->instanceName_.c_str(),
-        status, category, buf
-    );*/
+    this->log_.log( status, category, message, args );
 }
 
 void
-InstanceBase::logDebug(
+InstanceBase::logDebugMessage(
+    LogCategory category,
     const char *message,
     ...
 ) {
-    if ( fmi3True == this->getLoggingOn() ) {
-        va_list args;
-        va_start( args, message );
-        this->logMessage( fmi3OK, "DEBUG", message, args );
-        va_end( args );
-    }
+    va_list args;
+    va_start( args, message );
+    this->logMessage( fmi3OK, logCategoryName( category ), message, args );
+    va_end( args );
 }
 
 void
@@ -651,3 +682,86 @@ InstanceBase::logError(
     this->logMessage( fmi3Error, "ERROR", message, args );
     va_end( args );
 }
+
+std::string
+InstanceBase::getResourceFile(
+    const std::string& fileName
+) {
+    const bool absolute = ( false == fileName.empty() ) &&
+        ( ( '/' == fileName[0] ) || ( '\\' == fileName[0] ) || ( ( 1 < fileName.size() ) && ( ':' == fileName[1] ) ) );
+
+    if ( absolute ) return fileName;
+
+    std::string path = this->resourceLocation_;
+
+    if ( 0 == path.compare( 0, 7, "file://" ) )
+    {
+        path.erase( 0, 7 );
+    }
+
+    if ( ( false == path.empty() ) && ( '/' != path.back() ) && ( '\\' != path.back() ) )
+    {
+        path += '/';
+    }
+
+    return path + fileName;
+}
+
+std::string
+InstanceBase::getOutputFile(
+    const std::string& fileName,
+    const char* environmentVariable
+) {
+    const char* directory = std::getenv( environmentVariable );
+
+    if ( ( nullptr == directory ) || ( 0 == *directory ) ) return this->getResourceFile( fileName );
+
+    std::string path = directory;
+
+    if ( ( '/' != path.back() ) && ( '\\' != path.back() ) )
+    {
+        path += '/';
+    }
+
+    return path + fileName;
+}
+
+#ifdef FMU_CALL_PROFILING
+fmi3Status
+InstanceBase::writeCallProfile(
+    fmi3String fileName
+) {
+    std::string path;
+
+    if ( nullptr != fileName )
+    {
+        path = fileName;
+    }
+    else
+    {
+        const char* directory = std::getenv( "FMU_CALL_PROFILE_DIR" );
+        path = ( nullptr != directory ) ? std::string( directory ) + "/" : std::string();
+
+        // The instance name may contain characters that are not allowed in file names.
+        for ( char c : this->instanceName_ )
+        {
+            path += std::isalnum( static_cast<unsigned char>( c ) ) ? c : '_';
+        }
+
+        path += ".calls.json";
+    }
+
+    FILE* file = std::fopen( path.c_str(), "w" );
+
+    if ( nullptr == file )
+    {
+        this->logError( "Cannot open call profile file %s", path.c_str() );
+        return fmi3Error;
+    }
+
+    this->callProfiler_.writeJson( file, this->instanceName_.c_str() );
+    std::fclose( file );
+
+    return fmi3OK;
+}
+#endif
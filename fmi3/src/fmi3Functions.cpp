@@ -29,11 +29,25 @@
     impl->logError( "Function is not implemented." ); \
     return fmi3Error;
 
+#ifdef FMU_CALL_PROFILING
+
+// Every call is timed and recorded in the instance's call profiler (see CallProfiler.h).
 #define CHECK_STATE_AND_CALL_METHOD( METHOD_STUB, ... ) \
     InstanceBase* impl = static_cast<InstanceBase*>( instance ); \
     if( !AllowedFMUMode::check( impl, AllowedFMUMode::METHOD_STUB, #METHOD_STUB ) ) { return fmi3Error; } \
+    static const size_t callId = CallProfiler::registerCall( __func__ ); \
+    CallProfiler::Timer timer( impl->getCallProfiler(), callId ); \
     return impl->METHOD_STUB( __VA_ARGS__ );
 
+#else
+
+#define CHECK_STATE_AND_CALL_METHOD( METHOD_STUB, ... ) \
+    InstanceBase* impl = static_cast<InstanceBase*>( instance ); \
+    if( !AllowedFMUMode::check( impl, AllowedFMUMode::METHOD_STUB, #METHOD_STUB ) ) { return fmi3Error; } \
+    return impl->METHOD_STUB( __VA_ARGS__ );
+
+#endif
+
 
 const char* fmi3GetVersion()
 {
@@ -132,6 +146,11 @@ void fmi3FreeInstance(
     fmi3Instance instance
 ) {
     INSTANCE_TYPE* impl = static_cast<INSTANCE_TYPE*>( instance );
+
+#ifdef FMU_CALL_PROFILING
+    impl->writeCallProfile( nullptr );
+#endif
+
     delete impl;
 }
 
@@ -693,7 +712,7 @@ fmi3Status fmi3SerializeFMUState(
     )
 }
 
-fmi3Status fmi3DeSerializeFMUState (
+fmi3Status fmi3DeserializeFMUState(
     fmi3Instance instance,
     const fmi3Byte serializedState[],
     size_t size,
@@ -1033,3 +1052,23 @@ fmi3Status fmi3ActivateModelPartition(
 ) {
     NOT_IMPLEMENTED
 }
+
+/**
+ * Write the call profile (call counts and latency histograms of all FMI functions) of an
+ * instance in JSON format. This function is not part of the FMI standard. If no file name
+ * is given, the default location is used (see InstanceBase::writeCallProfile). Returns
+ * fmi3Error if the FMU has not been compiled with FMU_CALL_PROFILING.
+ */
+extern "C" FMI3_Export fmi3Status writeCallProfile(
+    fmi3Instance instance,
+    fmi3String fileName
+) {
+    InstanceBase* impl = static_cast<InstanceBase*>( instance );
+
+#ifdef FMU_CALL_PROFILING
+    return impl->writeCallProfile( fileName );
+#else
+    impl->logError( "Call profiling is not enabled (compile with FMU_CALL_PROFILING)." );
+    return fmi3Error;
+#endif
+}
@@ -0,0 +1,123 @@
+/**************************************************************************
+ * Copyright (c) ERIGrid 2.0 (H2020 Programme Grant Agreement No. 870620) *
+ * All rights reserved.                                                   *
+ * See file LICENSE in the project root for license information.          *
+ **************************************************************************/
+
+#ifndef FmuLibrary_h
+#define FmuLibrary_h
+
+// Helpers of the tests for loading an extracted FMU as built in <build>/temp/<model name>, i.e.,
+// modelDescription.xml, binaries/<platform>/<model identifier><suffix> and resources. The
+// platform and the suffix of shared libraries are given by the macros FMI_PLATFORM and
+// FMU_LIBRARY_SUFFIX (see CMakeLists.txt).
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+namespace FmuLibrary
+{
+    // Value of an attribute of an XML element (empty if the element's start tag has no such
+    // attribute).
+    inline std::string attribute( const std::string& element, const char* name )
+    {
+        const std::string tag = element.substr( 0, element.find( '>' ) );
+        const std::string key = std::string( " " ) + name + "=\"";
+        size_t begin = tag.find( key );
+        if ( std::string::npos == begin ) return std::string();
+
+        begin += key.size();
+        return tag.substr( begin, tag.find( '"', begin ) - begin );
+    }
+
+    // All elements with the given name, each including its child elements.
+    inline std::vector<std::string> elements( const std::string& xml, const std::string& name )
+    {
+        std::vector<std::string> result;
+        const std::string open = "<" + name + " ";
+        const std::string close = "</" + name + ">";
+
+        for ( size_t begin = xml.find( open ); std::string::npos != begin; begin = xml.find( open, begin + 1 ) )
+        {
+            size_t end = xml.find( '>', begin );
+            if ( std::string::npos == end ) break;
+
+            if ( '/' != xml[end - 1] )
+            {
+                end = xml.find( close, end );
+                if ( std::string::npos == end ) break;
+                end += close.size() - 1;
+            }
+
+            result.push_back( xml.substr( begin, end + 1 - begin ) );
+        }
+
+        return result;
+    }
+
+    // Read the model description of an extracted FMU.
+    inline bool readModelDescription( const std::string& directory, std::string& xml )
+    {
+        const std::string path = directory + "/modelDescription.xml";
+        std::ifstream file( path.c_str() );
+        if ( !file )
+        {
+            std::fprintf( stderr, "cannot open %s\n", path.c_str() );
+            return false;
+        }
+
+        std::stringstream text;
+        text << file.rdbuf();
+        xml = text.str();
+
+        if ( std::string::npos == xml.find( "<fmiModelDescription" ) )
+        {
+            std::fprintf( stderr, "%s is not a model description\n", path.c_str() );
+            return false;
+        }
+
+        return true;
+    }
+
+    // Load the shared library of an extracted FMU (nullptr on failure). The model identifier
+    // is the name of the directory.
+    inline void* open( const std::string& directory )
+    {
+        const size_t slash = directory.find_last_of( "/\\" );
+        const std::string modelIdentifier = ( std::string::npos == slash ) ? directory : directory.substr( slash + 1 );
+        const std::string path = directory + "/binaries/" FMI_PLATFORM "/" + modelIdentifier + FMU_LIBRARY_SUFFIX;
+
+#ifdef _WIN32
+        void* library = LoadLibraryA( path.c_str() );
+#else
+        void* library = dlopen( path.c_str(), RTLD_NOW | RTLD_LOCAL );
+#endif
+        if ( nullptr == library ) std::fprintf( stderr, "cannot load %s\n", path.c_str() );
+
+        return library;
+    }
+
+    template<typename F>
+    bool loadFunction( void* library, const char* name, F*& function )
+    {
+#ifdef _WIN32
+        function = reinterpret_cast<F*>( GetProcAddress( static_cast<HMODULE>( library ), name ) );
+#else
+        function = reinterpret_cast<F*>( dlsym( library, name ) );
+#endif
+        if ( nullptr == function ) std::fprintf( stderr, "missing function %s\n", name );
+
+        return ( nullptr != function );
+    }
+}
+
+#endif // FmuLibrary_h
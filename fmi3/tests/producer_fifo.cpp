@@ -0,0 +1,198 @@
+/**************************************************************************
+ * Copyright (c) ERIGrid 2.0 (H2020 Programme Grant Agreement No. 870620) *
+ * All rights reserved.                                                   *
+ * See file LICENSE in the project root for license information.          *
+ **************************************************************************/
+
+// Test of the producer entry point of Pipeline_unpredictable (CMake option
+// UNPREDICTABLE_EVENT_STACK_SPSC, see Pipeline_unpredictableProducer.h).
+//
+// A producer thread adds the messages 0, 1, 2, ... with Pipeline_unpredictable_pushFromProducer
+// (and retries while the producer stack is full), while the importer's thread steps the
+// instance and collects the delivered messages. Every message has to be delivered exactly
+// once, in the order in which it was added. The exit code is 0 if this is the case.
+//
+// The FMU is given as the directory of an extracted FMU, i.e., <build>/temp/Pipeline_unpredictable.
+//
+// Usage: producer_fifo fmu_dir [messages]
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#include "fmi3FunctionTypes.h"
+#include "Pipeline_unpredictableProducer.h"
+#include "FmuLibrary.h"
+
+namespace
+{
+    // Output "out" and its clock "outClock".
+    const fmi3ValueReference vrOut = 2001;
+    const fmi3ValueReference vrOutClock = 2002;
+
+    // Communication step size of the importer (seconds).
+    const fmi3Float64 stepSize = 0.01;
+
+    // Errors are reported by the test, log messages are dropped.
+    void logMessage( fmi3InstanceEnvironment, fmi3Status, fmi3String, fmi3String ) {}
+}
+
+int main( int argc, char* argv[] )
+{
+    const long nMessages = ( argc > 2 ) ? std::atol( argv[2] ) : 200000;
+
+    if ( ( argc < 2 ) || ( argc > 3 ) || ( 0 >= nMessages ) )
+    {
+        std::fprintf( stderr, "usage: %s fmu_dir [messages]\n", argv[0] );
+        return 1;
+    }
+
+    const std::string directory = argv[1];
+
+    std::string xml;
+    if ( false == FmuLibrary::readModelDescription( directory, xml ) ) return 1;
+
+    void* library = FmuLibrary::open( directory );
+    if ( nullptr == library ) return 1;
+
+    fmi3InstantiateCoSimulationTYPE* instantiateCoSimulation;
+    fmi3FreeInstanceTYPE* freeInstance;
+    fmi3EnterInitializationModeTYPE* enterInitializationMode;
+    fmi3ExitInitializationModeTYPE* exitInitializationMode;
+    fmi3EnterEventModeTYPE* enterEventMode;
+    fmi3EnterStepModeTYPE* enterStepMode;
+    fmi3UpdateDiscreteStatesTYPE* updateDiscreteStates;
+    fmi3DoStepTYPE* doStep;
+    fmi3GetInt32TYPE* getInt32;
+    fmi3GetClockTYPE* getClock;
+    Pipeline_unpredictable_pushFromProducerTYPE* pushFromProducer;
+
+    using FmuLibrary::loadFunction;
+    if ( ( false == loadFunction( library, "fmi3InstantiateCoSimulation", instantiateCoSimulation ) ) ||
+        ( false == loadFunction( library, "fmi3FreeInstance", freeInstance ) ) ||
+        ( false == loadFunction( library, "fmi3EnterInitializationMode", enterInitializationMode ) ) ||
+        ( false == loadFunction( library, "fmi3ExitInitializationMode", exitInitializationMode ) ) ||
+        ( false == loadFunction( library, "fmi3EnterEventMode", enterEventMode ) ) ||
+        ( false == loadFunction( library, "fmi3EnterStepMode", enterStepMode ) ) ||
+        ( false == loadFunction( library, "fmi3UpdateDiscreteStates", updateDiscreteStates ) ) ||
+        ( false == loadFunction( library, "fmi3DoStep", doStep ) ) ||
+        ( false == loadFunction( library, "fmi3GetInt32", getInt32 ) ) ||
+        ( false == loadFunction( library, "fmi3GetClock", getClock ) ) ||
+        ( false == loadFunction( library, "Pipeline_unpredictable_pushFromProducer", pushFromProducer ) ) )
+    {
+        return 1;
+    }
+
+    const std::string instantiationToken = FmuLibrary::attribute( xml.substr( xml.find( "<fmiModelDescription" ) ), "instantiationToken" );
+    const std::string resourceLocation = directory + "/resources/";
+
+    fmi3Instance instance = instantiateCoSimulation(
+        "producer", instantiationToken.c_str(), resourceLocation.c_str(),
+        fmi3False, fmi3False, fmi3True, fmi3True, nullptr, 0, nullptr, logMessage, nullptr
+    );
+
+    if ( ( nullptr == instance ) ||
+        ( fmi3OK != enterInitializationMode( instance, fmi3False, 0., 0., fmi3False, 0. ) ) ||
+        ( fmi3OK != exitInitializationMode( instance ) ) )
+    {
+        std::fprintf( stderr, "cannot initialize the instance\n" );
+        return 1;
+    }
+
+    // Producer thread, started when the importer starts stepping.
+    std::atomic<bool> start( false );
+    std::atomic<bool> stop( false );
+    std::atomic<bool> producerFailed( false );
+    long retries = 0;
+
+    std::thread producer(
+        [&]()
+        {
+            while ( false == start.load() ) std::this_thread::yield();
+
+            for ( fmi3Int32 msgId = 0; ( msgId < nMessages ) && ( false == stop.load() ); ++msgId )
+            {
+                fmi3Status status;
+                while ( ( fmi3Discard == ( status = pushFromProducer( instance, msgId ) ) ) && ( false == stop.load() ) )
+                {
+                    ++retries;
+                    std::this_thread::yield();
+                }
+
+                if ( ( fmi3OK != status ) && ( fmi3Discard != status ) )
+                {
+                    producerFailed.store( true );
+                    return;
+                }
+            }
+        }
+    );
+
+    // Importer's thread: step and collect the delivered messages until all of them have been
+    // delivered, a message is out of order, or the importer does not advance any more.
+    start.store( true );
+
+    long delivered = 0;
+    long steps = 0;
+    bool ok = true;
+    fmi3Float64 time = 0.;
+
+    while ( ok && ( delivered < nMessages ) && ( false == producerFailed.load() ) )
+    {
+        fmi3Boolean eventEncountered = fmi3False, terminateSimulation = fmi3False, earlyReturn = fmi3False;
+        fmi3Float64 lastSuccessfulTime = time;
+
+        ok = ( fmi3OK == doStep( instance, time, stepSize, fmi3True, &eventEncountered, &terminateSimulation, &earlyReturn, &lastSuccessfulTime ) );
+        time = lastSuccessfulTime;
+
+        if ( ok && eventEncountered )
+        {
+            fmi3Clock ticked = fmi3ClockInactive;
+            fmi3Int32 msgId = -1;
+            fmi3Boolean discreteStatesNeedUpdate, nominalsChanged, valuesChanged, nextEventTimeDefined;
+            fmi3Float64 nextEventTime;
+
+            ok = ( fmi3OK == enterEventMode( instance ) ) &&
+                ( fmi3OK == getClock( instance, &vrOutClock, 1, &ticked ) ) &&
+                ( fmi3OK == getInt32( instance, &vrOut, 1, &msgId, 1 ) );
+
+            if ( ok && ticked )
+            {
+                if ( msgId != delivered )
+                {
+                    std::printf( "message %d delivered, expected message %ld\n", msgId, delivered );
+                    ok = false;
+                }
+
+                ++delivered;
+            }
+
+            ok = ok && ( fmi3OK == updateDiscreteStates(
+                instance, &discreteStatesNeedUpdate, &terminateSimulation, &nominalsChanged, &valuesChanged, &nextEventTimeDefined, &nextEventTime
+            ) );
+            ok = ok && ( fmi3OK == enterStepMode( instance ) );
+        }
+
+        if ( ++steps > 100L * nMessages + 100000 )
+        {
+            std::printf( "no progress after %ld steps\n", steps );
+            ok = false;
+        }
+    }
+
+    // The producer thread has to be finished before the instance is freed.
+    stop.store( true );
+    producer.join();
+    freeInstance( instance );
+
+    std::printf(
+        "%ld of %ld messages delivered in order (%ld steps, %ld retries on a full producer stack)\n",
+        delivered, nMessages, steps, retries
+    );
+
+    if ( producerFailed.load() ) std::printf( "the producer entry point failed\n" );
+
+    return ( ok && ( delivered == nMessages ) && ( false == producerFailed.load() ) ) ? 0 : 1;
+}
@@ -0,0 +1,330 @@
+/**************************************************************************
+ * Copyright (c) ERIGrid 2.0 (H2020 Programme Grant Agreement No. 870620) *
+ * All rights reserved.                                                   *
+ * See file LICENSE in the project root for license information.          *
+ **************************************************************************/
+
+// Stress test for running many instances of a pipeline FMU in one process.
+//
+// A number of instances of the same FMU are simulated, each with its own tolerance and
+// random seed. Each instance receives one message per period (round robin over its
+// inputs) and the importer steps to each event only up to half of the instance's
+// tolerance before it. Hence, an instance that uses another instance's tolerance or
+// random state delivers different messages or at different times.
+//
+// Each instance is first simulated alone, on the main thread, to obtain a reference
+// delivery sequence. Then all instances are simulated again at the same time, each on its
+// own thread, and their delivery sequences are compared to the references. The exit code
+// is 0 if all of them are identical.
+//
+// The FMU is given as the directory of an extracted FMU, i.e., <build>/temp/Pipeline_deterministic
+// or <build>/temp/Pipeline_configurable (modelDescription.xml, binaries/<platform> and resources).
+// Messages are sent on the first clocked Int32 input of each input clock and read from the
+// first clocked Int32 output of each output clock.
+//
+// Usage: tolerance_stress fmu_dir [instances [messages]]
+
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "fmi3FunctionTypes.h"
+#include "FmuLibrary.h"
+
+namespace
+{
+    // Time between two messages sent to an instance (seconds).
+    const fmi3Float64 period = 0.05;
+
+    // Tolerance of the first instance, instance i uses ( i + 1 ) times this tolerance (seconds).
+    const fmi3Float64 baseTolerance = 1e-7;
+
+    // Random seed of the first instance (parameter randomSeed, value reference 3001).
+    const fmi3Int32 baseSeed = 1000;
+    const fmi3ValueReference vrRandomSeed = 3001;
+
+    // A clocked Int32 variable of the FMU.
+    struct ClockedVariable {
+        fmi3ValueReference valueReference;
+        fmi3ValueReference clock;
+    };
+
+    // The FMU's shared library and the parts of its model description used by the test.
+    struct Model {
+        std::string instantiationToken;
+        std::string resourceLocation;
+        std::vector<ClockedVariable> inputs;
+        std::vector<ClockedVariable> outputs;
+
+        fmi3InstantiateCoSimulationTYPE* instantiateCoSimulation;
+        fmi3FreeInstanceTYPE* freeInstance;
+        fmi3EnterInitializationModeTYPE* enterInitializationMode;
+        fmi3ExitInitializationModeTYPE* exitInitializationMode;
+        fmi3EnterEventModeTYPE* enterEventMode;
+        fmi3EnterStepModeTYPE* enterStepMode;
+        fmi3UpdateDiscreteStatesTYPE* updateDiscreteStates;
+        fmi3DoStepTYPE* doStep;
+        fmi3SetInt32TYPE* setInt32;
+        fmi3GetInt32TYPE* getInt32;
+        fmi3SetClockTYPE* setClock;
+        fmi3GetClockTYPE* getClock;
+    };
+
+    // A message delivered by an instance.
+    struct Delivery {
+        size_t output;
+        fmi3Int32 msgId;
+        fmi3Float64 time;
+
+        bool operator==( const Delivery& other ) const
+        {
+            return ( output == other.output ) && ( msgId == other.msgId ) && ( time == other.time );
+        }
+    };
+
+    // Result of the simulation of an instance.
+    struct Run {
+        bool ok;
+        std::vector<Delivery> deliveries;
+    };
+
+    // Read the instantiation token and the clocked Int32 inputs and outputs from the model
+    // description (for each clock, the first variable it clocks).
+    bool readModelDescription( const std::string& directory, Model& model )
+    {
+        std::string xml;
+        if ( false == FmuLibrary::readModelDescription( directory, xml ) ) return false;
+
+        model.instantiationToken = FmuLibrary::attribute( xml.substr( xml.find( "<fmiModelDescription" ) ), "instantiationToken" );
+
+        for ( const std::string& element : FmuLibrary::elements( xml, "Int32" ) )
+        {
+            const std::string causality = FmuLibrary::attribute( element, "causality" );
+            const std::string clocks = FmuLibrary::attribute( element, "clocks" );
+
+            if ( clocks.empty() || ( ( "input" != causality ) && ( "output" != causality ) ) ) continue;
+
+            ClockedVariable variable;
+            variable.valueReference = static_cast<fmi3ValueReference>( std::strtoul( FmuLibrary::attribute( element, "valueReference" ).c_str(), nullptr, 10 ) );
+            variable.clock = static_cast<fmi3ValueReference>( std::strtoul( clocks.c_str(), nullptr, 10 ) );
+
+            std::vector<ClockedVariable>& variables = ( "input" == causality ) ? model.inputs : model.outputs;
+
+            bool known = false;
+            for ( const ClockedVariable& v : variables ) known = known || ( v.clock == variable.clock );
+
+            if ( false == known ) variables.push_back( variable );
+        }
+
+        if ( model.inputs.empty() || model.outputs.empty() )
+        {
+            std::fprintf( stderr, "%s has no clocked Int32 inputs or outputs\n", directory.c_str() );
+            return false;
+        }
+
+        return true;
+    }
+
+    bool loadModel( const std::string& directory, Model& model )
+    {
+        if ( false == readModelDescription( directory, model ) ) return false;
+
+        void* library = FmuLibrary::open( directory );
+        if ( nullptr == library ) return false;
+
+        model.resourceLocation = directory + "/resources/";
+
+        using FmuLibrary::loadFunction;
+        return loadFunction( library, "fmi3InstantiateCoSimulation", model.instantiateCoSimulation ) &&
+            loadFunction( library, "fmi3FreeInstance", model.freeInstance ) &&
+            loadFunction( library, "fmi3EnterInitializationMode", model.enterInitializationMode ) &&
+            loadFunction( library, "fmi3ExitInitializationMode", model.exitInitializationMode ) &&
+            loadFunction( library, "fmi3EnterEventMode", model.enterEventMode ) &&
+            loadFunction( library, "fmi3EnterStepMode", model.enterStepMode ) &&
+            loadFunction( library, "fmi3UpdateDiscreteStates", model.updateDiscreteStates ) &&
+            loadFunction( library, "fmi3DoStep", model.doStep ) &&
+            loadFunction( library, "fmi3SetInt32", model.setInt32 ) &&
+            loadFunction( library, "fmi3GetInt32", model.getInt32 ) &&
+            loadFunction( library, "fmi3SetClock", model.setClock ) &&
+            loadFunction( library, "fmi3GetClock", model.getClock );
+    }
+
+    // Errors are reported by the run that encounters them, log messages are dropped.
+    void logMessage( fmi3InstanceEnvironment, fmi3Status, fmi3String, fmi3String ) {}
+
+    // Leave event mode, returns the time of the next event (infinity if there is none).
+    fmi3Float64 updateDiscreteStates( const Model& model, fmi3Instance instance, bool& ok )
+    {
+        fmi3Boolean discreteStatesNeedUpdate, terminateSimulation, nominalsChanged, valuesChanged, nextEventTimeDefined;
+        fmi3Float64 nextEventTime = 0.;
+
+        ok = ok && ( fmi3OK == model.updateDiscreteStates(
+            instance, &discreteStatesNeedUpdate, &terminateSimulation, &nominalsChanged, &valuesChanged, &nextEventTimeDefined, &nextEventTime
+        ) );
+        ok = ok && ( fmi3OK == model.enterStepMode( instance ) );
+
+        return nextEventTimeDefined ? nextEventTime : HUGE_VAL;
+    }
+
+    // Simulate instance i until all messages have been delivered (or dropped).
+    Run simulate( const Model& model, size_t i, int nMessages )
+    {
+        Run run;
+        run.ok = false;
+
+        char name[32];
+        std::snprintf( name, sizeof( name ), "pipeline%zu", i );
+
+        fmi3Instance instance = model.instantiateCoSimulation(
+            name, model.instantiationToken.c_str(), model.resourceLocation.c_str(),
+            fmi3False, fmi3False, fmi3True, fmi3True, nullptr, 0, nullptr, logMessage, nullptr
+        );
+
+        if ( nullptr == instance ) return run;
+
+        const fmi3Float64 tolerance = baseTolerance * static_cast<fmi3Float64>( i + 1 );
+        const fmi3Int32 seed = baseSeed + static_cast<fmi3Int32>( i );
+
+        bool ok = ( fmi3OK == model.setInt32( instance, &vrRandomSeed, 1, &seed, 1 ) ) &&
+            ( fmi3OK == model.enterInitializationMode( instance, fmi3True, tolerance, 0., fmi3False, 0. ) ) &&
+            ( fmi3OK == model.exitInitializationMode( instance ) );
+
+        const fmi3Float64 stopTime = nMessages * period + 100.;
+        fmi3Float64 time = 0.;
+        fmi3Float64 nextEventTime = HUGE_VAL;
+        int k = 0;
+        long steps = 0;
+
+        while ( ok && ( ( k < nMessages ) || ( time < stopTime ) ) )
+        {
+            // Send the next message (late if the instance has returned at an event that is
+            // due within tolerance after the message).
+            if ( ( k < nMessages ) && ( time > k * period - 1e-9 ) )
+            {
+                const ClockedVariable& input = model.inputs[ k % model.inputs.size() ];
+                const fmi3Int32 msgId = k++;
+                const fmi3Clock active = fmi3ClockActive;
+
+                ok = ( fmi3OK == model.enterEventMode( instance ) ) &&
+                    ( fmi3OK == model.setInt32( instance, &input.valueReference, 1, &msgId, 1 ) ) &&
+                    ( fmi3OK == model.setClock( instance, &input.clock, 1, &active ) );
+                nextEventTime = updateDiscreteStates( model, instance, ok );
+            }
+
+            // Step to the next message, or to just before the next event (within tolerance).
+            fmi3Float64 targetTime = ( k < nMessages ) ? k * period : stopTime;
+            if ( nextEventTime - 0.5 * tolerance < targetTime ) targetTime = nextEventTime - 0.5 * tolerance;
+            if ( targetTime < time ) targetTime = time;
+
+            fmi3Boolean eventEncountered = fmi3False, terminateSimulation = fmi3False, earlyReturn = fmi3False;
+            fmi3Float64 lastSuccessfulTime = time;
+
+            ok = ok && ( fmi3OK == model.doStep(
+                instance, time, targetTime - time, fmi3True, &eventEncountered, &terminateSimulation, &earlyReturn, &lastSuccessfulTime
+            ) );
+            time = lastSuccessfulTime;
+
+            // Collect the delivered messages.
+            if ( ok && eventEncountered )
+            {
+                ok = ( fmi3OK == model.enterEventMode( instance ) );
+
+                for ( size_t j = 0; ok && ( j < model.outputs.size() ); ++j )
+                {
+                    fmi3Clock ticked = fmi3ClockInactive;
+                    fmi3Int32 msgId = 0;
+
+                    ok = ( fmi3OK == model.getClock( instance, &model.outputs[j].clock, 1, &ticked ) ) &&
+                        ( fmi3OK == model.getInt32( instance, &model.outputs[j].valueReference, 1, &msgId, 1 ) );
+
+                    if ( ok && ticked ) run.deliveries.push_back( Delivery{ j, msgId, time } );
+                }
+
+                nextEventTime = updateDiscreteStates( model, instance, ok );
+            }
+
+            // The importer does not advance (e.g., the instance does not accept its tolerance).
+            if ( ++steps > 10L * nMessages + 1000 ) ok = false;
+        }
+
+        model.freeInstance( instance );
+
+        run.ok = ok;
+        return run;
+    }
+}
+
+int main( int argc, char* argv[] )
+{
+    size_t nInstances = ( argc > 2 ) ? std::strtoull( argv[2], nullptr, 10 ) : 48;
+    int nMessages = ( argc > 3 ) ? std::atoi( argv[3] ) : 2000;
+
+    if ( ( argc < 2 ) || ( argc > 4 ) || ( 0 == nInstances ) || ( 0 >= nMessages ) )
+    {
+        std::fprintf( stderr, "usage: %s fmu_dir [instances [messages]]\n", argv[0] );
+        return 1;
+    }
+
+    Model model;
+    if ( false == loadModel( argv[1], model ) ) return 1;
+
+    // Reference runs, one instance at a time.
+    std::vector<Run> references;
+    for ( size_t i = 0; i < nInstances; ++i )
+    {
+        references.push_back( simulate( model, i, nMessages ) );
+
+        if ( false == references.back().ok )
+        {
+            std::fprintf( stderr, "instance %zu failed when simulated alone\n", i );
+            return 1;
+        }
+    }
+
+    // Concurrent runs, one thread per instance, started at the same time.
+    std::vector<Run> runs( nInstances );
+    std::vector<std::thread> threads;
+    std::atomic<bool> start( false );
+
+    for ( size_t i = 0; i < nInstances; ++i )
+    {
+        threads.emplace_back(
+            [&model, &runs, &start, i, nMessages]()
+            {
+                while ( false == start.load() ) std::this_thread::yield();
+                runs[i] = simulate( model, i, nMessages );
+            }
+        );
+    }
+
+    start.store( true );
+    for ( std::thread& thread : threads ) thread.join();
+
+    size_t failures = 0;
+    size_t deliveries = 0;
+
+    for ( size_t i = 0; i < nInstances; ++i )
+    {
+        deliveries += references[i].deliveries.size();
+
+        if ( runs[i].ok && ( runs[i].deliveries == references[i].deliveries ) ) continue;
+
+        ++failures;
+        std::printf(
+            "instance %zu (tolerance %g): %s (%zu deliveries, %zu when simulated alone)\n",
+            i, baseTolerance * ( i + 1 ), runs[i].ok ? "deliveries differ" : "failed",
+            runs[i].deliveries.size(), references[i].deliveries.size()
+        );
+    }
+
+    std::printf(
+        "%zu of %zu instances identical to their single-threaded runs (%zu deliveries)\n",
+        nInstances - failures, nInstances, deliveries
+    );
+
+    return ( 0 == failures ) ? 0 : 1;
+}
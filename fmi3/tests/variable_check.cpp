@@ -0,0 +1,455 @@
+/**************************************************************************
+ * Copyright (c) ERIGrid 2.0 (H2020 Programme Grant Agreement No. 870620) *
+ * All rights reserved.                                                   *
+ * See file LICENSE in the project root for license information.          *
+ **************************************************************************/
+
+// Check of the variable tables of an FMU against its model description.
+//
+// Every variable declared in modelDescription.xml (except the independent variable) is
+// accessed with the getter and setter of its declared type and with the number of values
+// given by its dimensions. Hence, a variable that is missing from the FMU's tables, has
+// another type or value reference, or is a scalar instead of an array (or vice versa)
+// is reported. Its causality is checked with the rules for setting variables:
+//
+//  - structural parameters can be set after instantiation, but not in initialization mode,
+//  - parameters and inputs can be set in initialization mode,
+//  - outputs can never be set.
+//
+// Structural parameters are set to their start values after instantiation (they cannot be
+// read before), all other values are set to the values that have been read before. Input
+// clocks are only read, as setting them would activate them.
+//
+// The FMU is given as the directory of an extracted FMU, i.e., <build>/temp/<model name>.
+// The exit code is 0 if all variables match.
+//
+// Usage: variable_check fmu_dir
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "fmi3FunctionTypes.h"
+#include "FmuLibrary.h"
+
+namespace
+{
+    // Types of variables, i.e., the names of the elements in ModelVariables.
+    const char* const variableTypes[] = {
+        "Float32", "Float64", "Int8", "UInt8", "Int16", "UInt16", "Int32", "UInt32",
+        "Int64", "UInt64", "Boolean", "String", "Binary", "Clock"
+    };
+
+    // A variable of the model description.
+    struct Variable {
+        std::string type;
+        std::string name;
+        std::string causality;
+        std::string start;
+        fmi3ValueReference valueReference;
+
+        // Fixed dimensions (start) or structural parameters (valueReference), empty for scalars.
+        std::vector<std::string> dimensionStarts;
+        std::vector<fmi3ValueReference> dimensionReferences;
+    };
+
+    // Getters and setters of a variable type other than Binary and Clock.
+    template<typename T>
+    struct Accessors {
+        typedef fmi3Status GetTYPE( fmi3Instance, const fmi3ValueReference[], size_t, T[], size_t );
+        typedef fmi3Status SetTYPE( fmi3Instance, const fmi3ValueReference[], size_t, const T[], size_t );
+    };
+
+    // Value of a start attribute.
+    template<typename T>
+    void parseValue( const std::string& text, T& value )
+    {
+        if ( false == std::numeric_limits<T>::is_integer ) value = static_cast<T>( std::strtod( text.c_str(), nullptr ) );
+        else if ( std::numeric_limits<T>::is_signed ) value = static_cast<T>( std::strtoll( text.c_str(), nullptr, 10 ) );
+        else value = static_cast<T>( std::strtoull( text.c_str(), nullptr, 10 ) );
+    }
+
+    void parseValue( const std::string& text, fmi3Boolean& value )
+    {
+        value = ( "true" == text ) || ( "1" == text );
+    }
+
+    // Errors are reported by the test, log messages are dropped.
+    void logMessage( fmi3InstanceEnvironment, fmi3Status, fmi3String, fmi3String ) {}
+
+    // Read the variables of the model description.
+    std::vector<Variable> readVariables( const std::string& xml )
+    {
+        const size_t begin = xml.find( "<ModelVariables>" );
+        const size_t end = xml.find( "</ModelVariables>" );
+        const std::string modelVariables = xml.substr( begin, end - begin );
+
+        std::vector<Variable> variables;
+
+        for ( const char* type : variableTypes )
+        {
+            for ( const std::string& element : FmuLibrary::elements( modelVariables, type ) )
+            {
+                Variable variable;
+                variable.type = type;
+                variable.name = FmuLibrary::attribute( element, "name" );
+                variable.causality = FmuLibrary::attribute( element, "causality" );
+                variable.start = FmuLibrary::attribute( element, "start" );
+                variable.valueReference = std::strtoul( FmuLibrary::attribute( element, "valueReference" ).c_str(), nullptr, 10 );
+
+                if ( variable.causality.empty() ) variable.causality = "local";
+
+                for ( const std::string& dimension : FmuLibrary::elements( element, "Dimension" ) )
+                {
+                    const std::string start = FmuLibrary::attribute( dimension, "start" );
+
+                    if ( start.empty() )
+                    {
+                        variable.dimensionReferences.push_back(
+                            std::strtoul( FmuLibrary::attribute( dimension, "valueReference" ).c_str(), nullptr, 10 )
+                        );
+                    }
+                    else
+                    {
+                        variable.dimensionStarts.push_back( start );
+                    }
+                }
+
+                variables.push_back( variable );
+            }
+        }
+
+        return variables;
+    }
+
+    // Accesses the variables of an instance and counts the mismatches.
+    class Checker {
+
+    public:
+
+        Checker( void* library, fmi3Instance instance ) :
+            library_( library ),
+            instance_( instance ),
+            failures_( 0 )
+        {}
+
+        int failures() const { return this->failures_; }
+
+        // Check a variable after instantiation (only structural parameters) or in
+        // initialization mode (all variables).
+        void check( const Variable& variable, bool initializationMode )
+        {
+            const bool structural = ( "structuralParameter" == variable.causality );
+
+            if ( ( false == initializationMode ) && ( false == structural ) ) return;
+            if ( "independent" == variable.causality ) return;
+
+            size_t n;
+            if ( false == this->numberOfValues( variable, n ) ) return;
+
+            const bool settable = structural ?
+                ( false == initializationMode ) :
+                ( ( "parameter" == variable.causality ) || ( "input" == variable.causality ) );
+
+            const std::string& type = variable.type;
+
+            if ( "Float32" == type ) this->checkValues<fmi3Float32>( variable, n, settable );
+            else if ( "Float64" == type ) this->checkValues<fmi3Float64>( variable, n, settable );
+            else if ( "Int8" == type ) this->checkValues<fmi3Int8>( variable, n, settable );
+            else if ( "UInt8" == type ) this->checkValues<fmi3UInt8>( variable, n, settable );
+            else if ( "Int16" == type ) this->checkValues<fmi3Int16>( variable, n, settable );
+            else if ( "UInt16" == type ) this->checkValues<fmi3UInt16>( variable, n, settable );
+            else if ( "Int32" == type ) this->checkValues<fmi3Int32>( variable, n, settable );
+            else if ( "UInt32" == type ) this->checkValues<fmi3UInt32>( variable, n, settable );
+            else if ( "Int64" == type ) this->checkValues<fmi3Int64>( variable, n, settable );
+            else if ( "UInt64" == type ) this->checkValues<fmi3UInt64>( variable, n, settable );
+            else if ( "Boolean" == type ) this->checkValues<fmi3Boolean>( variable, n, settable );
+            else if ( "String" == type ) this->checkStrings( variable, n, settable );
+            else if ( "Binary" == type ) this->checkBinaries( variable, n, settable );
+            else if ( "Clock" == type ) this->checkClock( variable, n );
+        }
+
+    private:
+
+        void fail( const Variable& variable, const char* message, size_t n )
+        {
+            std::printf(
+                "%s %s (valueReference %u, %s): ", variable.type.c_str(), variable.name.c_str(),
+                variable.valueReference, variable.causality.c_str()
+            );
+            std::printf( message, n );
+            std::printf( "\n" );
+            ++this->failures_;
+        }
+
+        // Number of values of a variable, i.e., the product of its dimensions.
+        bool numberOfValues( const Variable& variable, size_t& n )
+        {
+            n = 1;
+
+            for ( const std::string& start : variable.dimensionStarts )
+            {
+                n *= std::strtoul( start.c_str(), nullptr, 10 );
+            }
+
+            Accessors<fmi3UInt64>::GetTYPE* getUInt64;
+            if ( false == this->loadFunction( "fmi3GetUInt64", getUInt64 ) ) return false;
+
+            for ( fmi3ValueReference dimension : variable.dimensionReferences )
+            {
+                fmi3UInt64 size = 0;
+                if ( fmi3OK != getUInt64( this->instance_, &dimension, 1, &size, 1 ) )
+                {
+                    this->fail( variable, "cannot get the dimension with valueReference %zu", dimension );
+                    return false;
+                }
+
+                n *= size;
+            }
+
+            return true;
+        }
+
+        template<typename F>
+        bool loadFunction( const std::string& name, F*& function )
+        {
+            if ( FmuLibrary::loadFunction( this->library_, name.c_str(), function ) ) return true;
+
+            ++this->failures_;
+            return false;
+        }
+
+        // Check the number of values, then set them (if settable) or check that they cannot be set.
+        // Structural parameters are set to their start values after instantiation instead.
+        template<typename T>
+        void checkValues( const Variable& variable, size_t n, bool settable )
+        {
+            typename Accessors<T>::GetTYPE* get;
+            typename Accessors<T>::SetTYPE* set;
+            if ( ( false == this->loadFunction( "fmi3Get" + variable.type, get ) ) ||
+                ( false == this->loadFunction( "fmi3Set" + variable.type, set ) ) )
+            {
+                return;
+            }
+
+            const fmi3ValueReference vr = variable.valueReference;
+
+            // Not std::vector, which has no data() for fmi3Boolean (i.e., bool).
+            std::unique_ptr<T[]> values( new T[n + 1]() );
+
+            if ( ( "structuralParameter" == variable.causality ) && settable )
+            {
+                if ( variable.start.empty() )
+                {
+                    this->fail( variable, "no start value (%zu values)", n );
+                    return;
+                }
+
+                for ( size_t i = 0; i < n; ++i ) parseValue( variable.start, values[i] );
+            }
+            else
+            {
+                if ( fmi3OK != get( this->instance_, &vr, 1, values.get(), n ) )
+                {
+                    this->fail( variable, "cannot get %zu values", n );
+                    return;
+                }
+
+                if ( fmi3OK == get( this->instance_, &vr, 1, values.get(), n + 1 ) )
+                {
+                    this->fail( variable, "getting %zu values succeeds", n + 1 );
+                }
+            }
+
+            this->checkSet( variable, n, settable, set( this->instance_, &vr, 1, values.get(), n ) );
+        }
+
+        void checkStrings( const Variable& variable, size_t n, bool settable )
+        {
+            Accessors<fmi3String>::GetTYPE* get;
+            Accessors<fmi3String>::SetTYPE* set;
+            if ( ( false == this->loadFunction( "fmi3GetString", get ) ) ||
+                ( false == this->loadFunction( "fmi3SetString", set ) ) )
+            {
+                return;
+            }
+
+            const fmi3ValueReference vr = variable.valueReference;
+            std::vector<fmi3String> values( n + 1 );
+
+            if ( fmi3OK != get( this->instance_, &vr, 1, values.data(), n ) )
+            {
+                this->fail( variable, "cannot get %zu values", n );
+                return;
+            }
+
+            // The strings returned by the getter are only valid until the variable is set.
+            std::vector<std::string> copies( values.begin(), values.begin() + n );
+            for ( size_t i = 0; i < n; ++i ) values[i] = copies[i].c_str();
+
+            if ( fmi3OK == get( this->instance_, &vr, 1, values.data(), n + 1 ) )
+            {
+                this->fail( variable, "getting %zu values succeeds", n + 1 );
+            }
+
+            for ( size_t i = 0; i < n; ++i ) values[i] = copies[i].c_str();
+
+            this->checkSet( variable, n, settable, set( this->instance_, &vr, 1, values.data(), n ) );
+        }
+
+        void checkBinaries( const Variable& variable, size_t n, bool settable )
+        {
+            fmi3GetBinaryTYPE* get;
+            fmi3SetBinaryTYPE* set;
+            if ( ( false == this->loadFunction( "fmi3GetBinary", get ) ) ||
+                ( false == this->loadFunction( "fmi3SetBinary", set ) ) )
+            {
+                return;
+            }
+
+            const fmi3ValueReference vr = variable.valueReference;
+            std::vector<size_t> sizes( n + 1 );
+            std::vector<fmi3Binary> values( n + 1 );
+
+            if ( fmi3OK != get( this->instance_, &vr, 1, sizes.data(), values.data(), n ) )
+            {
+                this->fail( variable, "cannot get %zu values", n );
+                return;
+            }
+
+            // The values returned by the getter are only valid until the variable is set.
+            std::vector< std::vector<fmi3Byte> > copies( n );
+            for ( size_t i = 0; i < n; ++i ) copies[i].assign( values[i], values[i] + sizes[i] );
+
+            if ( fmi3OK == get( this->instance_, &vr, 1, sizes.data(), values.data(), n + 1 ) )
+            {
+                this->fail( variable, "getting %zu values succeeds", n + 1 );
+            }
+
+            for ( size_t i = 0; i < n; ++i )
+            {
+                sizes[i] = copies[i].size();
+                values[i] = copies[i].data();
+            }
+
+            this->checkSet( variable, n, settable, set( this->instance_, &vr, 1, sizes.data(), values.data(), n ) );
+        }
+
+        // Clocks are scalar. Output clocks cannot be set, input clocks are not set.
+        void checkClock( const Variable& variable, size_t n )
+        {
+            fmi3GetClockTYPE* get;
+            fmi3SetClockTYPE* set;
+            if ( ( false == this->loadFunction( "fmi3GetClock", get ) ) ||
+                ( false == this->loadFunction( "fmi3SetClock", set ) ) )
+            {
+                return;
+            }
+
+            const fmi3ValueReference vr = variable.valueReference;
+            fmi3Clock value = fmi3ClockInactive;
+
+            if ( 1 != n )
+            {
+                this->fail( variable, "clock with %zu values", n );
+            }
+
+            if ( fmi3OK != get( this->instance_, &vr, 1, &value ) )
+            {
+                this->fail( variable, "cannot get %zu values", 1 );
+                return;
+            }
+
+            if ( "output" == variable.causality )
+            {
+                const fmi3Clock active = fmi3ClockActive;
+                this->checkSet( variable, 1, false, set( this->instance_, &vr, 1, &active ) );
+            }
+        }
+
+        void checkSet( const Variable& variable, size_t n, bool settable, fmi3Status status )
+        {
+            if ( settable && ( fmi3OK != status ) )
+            {
+                this->fail( variable, "cannot set %zu values", n );
+            }
+            else if ( ( false == settable ) && ( fmi3OK == status ) )
+            {
+                this->fail( variable, "setting %zu values succeeds", n );
+            }
+        }
+
+        void* const library_;
+        const fmi3Instance instance_;
+        int failures_;
+    };
+}
+
+int main( int argc, char* argv[] )
+{
+    if ( 2 != argc )
+    {
+        std::fprintf( stderr, "usage: %s fmu_dir\n", argv[0] );
+        return 1;
+    }
+
+    const std::string directory = argv[1];
+
+    std::string xml;
+    if ( false == FmuLibrary::readModelDescription( directory, xml ) ) return 1;
+
+    void* library = FmuLibrary::open( directory );
+    if ( nullptr == library ) return 1;
+
+    fmi3InstantiateCoSimulationTYPE* instantiateCoSimulation;
+    fmi3FreeInstanceTYPE* freeInstance;
+    fmi3EnterInitializationModeTYPE* enterInitializationMode;
+
+    using FmuLibrary::loadFunction;
+    if ( ( false == loadFunction( library, "fmi3InstantiateCoSimulation", instantiateCoSimulation ) ) ||
+        ( false == loadFunction( library, "fmi3FreeInstance", freeInstance ) ) ||
+        ( false == loadFunction( library, "fmi3EnterInitializationMode", enterInitializationMode ) ) )
+    {
+        return 1;
+    }
+
+    const std::vector<Variable> variables = readVariables( xml );
+
+    const std::string instantiationToken = FmuLibrary::attribute( xml.substr( xml.find( "<fmiModelDescription" ) ), "instantiationToken" );
+    const std::string resourceLocation = directory + "/resources/";
+
+    fmi3Instance instance = instantiateCoSimulation(
+        "variables", instantiationToken.c_str(), resourceLocation.c_str(),
+        fmi3False, fmi3False, fmi3True, fmi3True, nullptr, 0, nullptr, logMessage, nullptr
+    );
+
+    if ( nullptr == instance )
+    {
+        std::fprintf( stderr, "cannot instantiate the FMU\n" );
+        return 1;
+    }
+
+    Checker checker( library, instance );
+
+    // Structural parameters after instantiation, then all variables in initialization mode.
+    for ( const Variable& variable : variables ) checker.check( variable, false );
+
+    if ( fmi3OK != enterInitializationMode( instance, fmi3False, 0., 0., fmi3False, 0. ) )
+    {
+        std::fprintf( stderr, "cannot enter initialization mode\n" );
+        freeInstance( instance );
+        return 1;
+    }
+
+    for ( const Variable& variable : variables ) checker.check( variable, true );
+
+    freeInstance( instance );
+
+    std::printf( "%zu variables checked, %d mismatches\n", variables.size(), checker.failures() );
+
+    return ( 0 == checker.failures() ) ? 0 : 1;
+}
@@ -0,0 +1,187 @@
+/**************************************************************************
+ * Copyright (c) ERIGrid 2.0 (H2020 Programme Grant Agreement No. 870620) *
+ * All rights reserved.                                                   *
+ * See file LICENSE in the project root for license information.          *
+ **************************************************************************/
+
+// Convert a binary message trace of a pipeline FMU (see EventTrace.h) to CSV.
+//
+// By default, one row is written per message, joining its ingress and egress records.
+// Messages are matched by ID, channel and due time (input time plus sampled delay), as a
+// message is delivered when it is due. Hence, messages with the same ID are paired
+// correctly even if they overtake each other. Messages that agree in all three are
+// paired in the order of their arrival (the order in which they are delivered):
+//   msg_id,channel,input_time,sampled_delay,delivery_time
+// Times are given in seconds. Messages still in flight have an empty delivery time.
+// With option --raw, all valid records are written in the order they were recorded:
+//   sequence,kind,msg_id,channel,time,delay
+//
+// Usage: trace_reader [--raw] trace_file [csv_file]
+// (the CSV is written to stdout if no output file is given)
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "EventTrace.h"
+
+using namespace EventTraceFormat;
+
+namespace
+{
+    struct Message {
+        Record ingress;
+        bool delivered;
+        int64_t deliveryTime;
+    };
+
+    // Read a trace file, returns the valid records sorted by sequence number.
+    bool readTrace( const char* path, Header& header, std::vector<Record>& records )
+    {
+        FILE* file = std::fopen( path, "rb" );
+        if ( nullptr == file )
+        {
+            std::fprintf( stderr, "cannot open %s\n", path );
+            return false;
+        }
+
+        bool ok = ( 1 == std::fread( &header, sizeof( Header ), 1, file ) );
+
+        if ( !ok || ( magic != header.magic ) || ( version != header.version ) || ( sizeof( Record ) != header.recordSize ) )
+        {
+            std::fprintf( stderr, "%s is not a message trace (version %u)\n", path, version );
+            std::fclose( file );
+            return false;
+        }
+
+        records.resize( header.capacity );
+        size_t n = std::fread( records.data(), sizeof( Record ), records.size(), file );
+        std::fclose( file );
+        records.resize( n );
+
+        // The trace is a ring, the records are ordered by their sequence numbers.
+        std::vector<Record> valid;
+        valid.reserve( n );
+
+        for ( size_t i = 0; i < n; ++i )
+        {
+            if ( 0 != records[i].sequence ) valid.push_back( records[i] );
+        }
+
+        std::sort(
+            valid.begin(), valid.end(),
+            []( const Record& r1, const Record& r2 ) { return r1.sequence < r2.sequence; }
+        );
+
+        records.swap( valid );
+        return true;
+    }
+}
+
+int main( int argc, char* argv[] )
+{
+    bool raw = ( argc > 1 ) && ( 0 == std::strcmp( argv[1], "--raw" ) );
+    int first = raw ? 2 : 1;
+
+    if ( ( argc <= first ) || ( argc > first + 2 ) )
+    {
+        std::fprintf( stderr, "usage: %s [--raw] trace_file [csv_file]\n", argv[0] );
+        return 1;
+    }
+
+    Header header;
+    std::vector<Record> records;
+
+    if ( false == readTrace( argv[first], header, records ) ) return 1;
+
+    FILE* out = ( argc == first + 2 ) ? std::fopen( argv[first + 1], "w" ) : stdout;
+    if ( nullptr == out )
+    {
+        std::fprintf( stderr, "cannot open %s\n", argv[first + 1] );
+        return 1;
+    }
+
+    const double secondsPerTick = 1. / header.ticksPerSecond;
+
+    if ( header.count > records.size() )
+    {
+        std::fprintf(
+            stderr, "%llu records have been overwritten (trace capacity %llu)\n",
+            static_cast<unsigned long long>( header.count - records.size() ),
+            static_cast<unsigned long long>( header.capacity )
+        );
+    }
+
+    if ( raw )
+    {
+        std::fprintf( out, "sequence,kind,msg_id,channel,time,delay\n" );
+
+        for ( const Record& r : records )
+        {
+            std::fprintf(
+                out, "%llu,%s,%d,%u,%.9f,%.9f\n",
+                static_cast<unsigned long long>( r.sequence ),
+                ( ingress == r.kind ) ? "ingress" : "egress",
+                r.msgId, static_cast<unsigned>( r.channel ),
+                r.time * secondsPerTick, r.delay * secondsPerTick
+            );
+        }
+    }
+    else
+    {
+        // Messages in the order of their arrival, and the undelivered ones by ID and channel,
+        // sorted by their due time.
+        std::vector<Message> messages;
+        std::map< std::pair<int32_t, uint16_t>, std::multimap<int64_t, size_t> > inFlight;
+
+        for ( const Record& r : records )
+        {
+            std::multimap<int64_t, size_t>& pending = inFlight[ std::make_pair( r.msgId, r.channel ) ];
+
+            if ( ingress == r.kind )
+            {
+                Message m = { r, false, 0 };
+                pending.insert( std::make_pair( r.time + r.delay, messages.size() ) );
+                messages.push_back( m );
+                continue;
+            }
+
+            // The message due at the delivery time (the earliest arrival first). Otherwise,
+            // the latest message due before, e.g., if the importer returned late.
+            std::multimap<int64_t, size_t>::iterator it = pending.lower_bound( r.time );
+
+            if ( ( pending.end() == it ) || ( r.time != it->first ) )
+            {
+                // The ingress record may have been overwritten.
+                if ( pending.begin() == it ) continue;
+                --it;
+            }
+
+            messages[ it->second ].delivered = true;
+            messages[ it->second ].deliveryTime = r.time;
+            pending.erase( it );
+        }
+
+        std::fprintf( out, "msg_id,channel,input_time,sampled_delay,delivery_time\n" );
+
+        for ( const Message& m : messages )
+        {
+            std::fprintf(
+                out, "%d,%u,%.9f,%.9f,",
+                m.ingress.msgId, static_cast<unsigned>( m.ingress.channel ),
+                m.ingress.time * secondsPerTick, m.ingress.delay * secondsPerTick
+            );
+
+            if ( m.delivered ) std::fprintf( out, "%.9f\n", m.deliveryTime * secondsPerTick );
+            else std::fprintf( out, "\n" );
+        }
+    }
+
+    if ( stdout != out ) std::fclose( out );
+
+    return 0;
+}